@@ -0,0 +1,547 @@
+#ifndef REGULUS_SMALL_VECTOR_HPP_
+#define REGULUS_SMALL_VECTOR_HPP_
+
+#include "static-vector.hpp"
+
+namespace regulus
+{
+  /**
+    * small_vector keeps up to N elements in the same kind of
+    * aligned inline storage static_vector uses and only goes to
+    * the heap once it outgrows it. The heap buffer grows
+    * geometrically from there on.
+    */
+  template <
+    typename T,
+    std::size_t N,
+    typename = std::enable_if_t<std::is_move_constructible<T>::value>
+  >
+  class small_vector
+  {
+  public:
+    // Member Types
+    typedef T                 value_type;
+    typedef std::size_t       size_type;
+    typedef std::ptrdiff_t    difference_type;
+    typedef value_type&       reference;
+    typedef value_type const& const_reference;
+    typedef value_type*       pointer;
+    typedef value_type const* const_pointer;
+    
+    typedef pointer                               iterator;
+    typedef const_pointer                         const_iterator;
+    typedef std::reverse_iterator<iterator>       reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+  
+  private:
+    // data_ points either at inline_ or at a heap buffer
+    pointer                                       data_;
+    size_type                                     size_;
+    size_type                                     capacity_;
+    std::aligned_storage_t<sizeof(T), alignof(T)> inline_[N];
+    
+    inline pointer inline_data(void)
+    {
+      return reinterpret_cast<pointer>(inline_);
+    }
+    
+    inline bool is_inline(void) const
+    {
+      return data_ == reinterpret_cast<const_pointer>(inline_);
+    }
+    
+    static pointer allocate(size_type const count)
+    {
+      return std::allocator<value_type>{}.allocate(count);
+    }
+    
+    // hands the heap buffer back, if we have one
+    void release(void)
+    {
+      if (!is_inline()) {
+        std::allocator<value_type>{}.deallocate(data_, capacity_);
+      }
+      data_ = inline_data();
+      capacity_ = N;
+    }
+    
+    size_type grown_capacity(size_type const required) const
+    {
+      return std::max(capacity_ * 2, required);
+    }
+    
+    // destroys elements off the back until count are left
+    void truncate(size_type const count)
+    {
+      while (size_ > count) {
+        pop_back();
+      }
+    }
+    
+    // opens up a hole of count uninitialized slots at offset, moving
+    // to a bigger buffer first if we have to. either way every element
+    // is relocated at most once.
+    pointer make_room(size_type const offset, size_type const count)
+    {
+      auto const pos = data_ + offset;
+      auto const last = data_ + size_;
+      
+      if (count <= capacity_ - size_) {
+        detail::relocate(pos, last, pos + count);
+        return pos;
+      }
+      
+      auto const new_capacity = grown_capacity(size_ + count);
+      auto const buf = allocate(new_capacity);
+      
+      detail::relocate(data_, pos, buf);
+      detail::relocate(pos, last, buf + offset + count);
+      
+      release();
+      data_ = buf;
+      capacity_ = new_capacity;
+      
+      return buf + offset;
+    }
+    
+    // undoes make_room() when constructing into the hole failed
+    void close_room(pointer const pos, size_type const count)
+    {
+      detail::relocate(pos + count, data_ + size_ + count, pos);
+    }
+    
+    template <typename ForwardIt>
+    iterator insert_range(
+      const_iterator it, ForwardIt first, ForwardIt last,
+      std::forward_iterator_tag)
+    {
+      auto const count = static_cast<size_type>(std::distance(first, last));
+      auto const pos = make_room(it - cbegin(), count);
+      
+      try {
+        detail::uninitialized_copy(first, last, pos);
+      } catch (...) {
+        close_room(pos, count);
+        throw;
+      }
+      
+      size_ += count;
+      return pos;
+    }
+    
+    template <typename InputIt>
+    iterator insert_range(
+      const_iterator it, InputIt first, InputIt last,
+      std::input_iterator_tag)
+    {
+      auto const offset = it - cbegin();
+      auto const old_size = size_;
+      
+      for (; first != last; ++first) {
+        emplace_back(*first);
+      }
+      
+      std::rotate(begin() + offset, begin() + old_size, end());
+      return begin() + offset;
+    }
+    
+    // steals other's heap buffer or relocates its inline elements
+    void take(small_vector& other)
+    {
+      if (other.is_inline()) {
+        detail::relocate(other.data_, other.data_ + other.size_, data_);
+      } else {
+        data_ = other.data_;
+        capacity_ = other.capacity_;
+        other.data_ = other.inline_data();
+        other.capacity_ = N;
+      }
+      size_ = other.size_;
+      other.size_ = 0;
+    }
+  
+  public:
+    small_vector(void)
+      : data_{inline_data()}
+      , size_{0}
+      , capacity_{N}
+    {}
+    
+    small_vector(size_type const count, const_reference val)
+      : small_vector()
+    {
+      insert(cend(), count, val);
+    }
+    
+    small_vector(std::initializer_list<value_type> init)
+      : small_vector()
+    {
+      insert(cend(), init.begin(), init.end());
+    }
+    
+    small_vector(small_vector const& other)
+      : small_vector()
+    {
+      insert(cend(), other.begin(), other.end());
+    }
+    
+    small_vector(small_vector&& other)
+      noexcept(std::is_nothrow_move_constructible<value_type>::value)
+      : small_vector()
+    {
+      take(other);
+    }
+    
+    ~small_vector(void)
+    {
+      clear();
+      release();
+    }
+    
+    small_vector& operator=(small_vector const& other)
+    {
+      if (this != std::addressof(other)) {
+        assign(other.begin(), other.end());
+      }
+      return *this;
+    }
+    
+    small_vector& operator=(small_vector&& other)
+      noexcept(std::is_nothrow_move_constructible<value_type>::value)
+    {
+      if (this != std::addressof(other)) {
+        clear();
+        release();
+        take(other);
+      }
+      return *this;
+    }
+    
+    void swap(small_vector& other)
+      noexcept(std::is_nothrow_move_constructible<value_type>::value)
+    {
+      small_vector tmp{std::move(other)};
+      other = std::move(*this);
+      *this = std::move(tmp);
+    }
+    
+    // Element Access
+    reference at(size_type const pos)
+    {
+      if (pos >= size_) {
+        throw std::out_of_range{"Index is out of bounds!"};
+      }
+      return this->operator[](pos);
+    }
+    
+    const_reference at(size_type const pos) const
+    {
+      if (pos >= size_) {
+        throw std::out_of_range{"Index is out of bounds!"};
+      }
+      return this->operator[](pos);
+    }
+    
+    reference operator[](size_type const pos)
+    {
+      return data_[pos];
+    }
+    
+    const_reference operator[](size_type const pos) const
+    {
+      return data_[pos];
+    }
+    
+    reference front(void)
+    {
+      return data_[0];
+    }
+    
+    const_reference front(void) const
+    {
+      return data_[0];
+    }
+    
+    reference back(void)
+    {
+      return data_[size_ - 1];
+    }
+    
+    const_reference back(void) const
+    {
+      return data_[size_ - 1];
+    }
+    
+    pointer data(void)
+    {
+      return data_;
+    }
+    
+    const_pointer data(void) const
+    {
+      return data_;
+    }
+    
+    // Iterators
+    iterator begin(void)
+    {
+      return data_;
+    }
+    
+    const_iterator begin(void) const
+    {
+      return data_;
+    }
+    
+    const_iterator cbegin(void) const
+    {
+      return data_;
+    }
+    
+    iterator end(void)
+    {
+      return data_ + size_;
+    }
+    
+    const_iterator end(void) const
+    {
+      return data_ + size_;
+    }
+    
+    const_iterator cend(void) const
+    {
+      return data_ + size_;
+    }
+    
+    reverse_iterator rbegin(void)
+    {
+      return reverse_iterator{end()};
+    }
+    
+    const_reverse_iterator rbegin(void) const
+    {
+      return const_reverse_iterator{end()};
+    }
+    
+    const_reverse_iterator crbegin(void) const
+    {
+      return const_reverse_iterator{end()};
+    }
+    
+    reverse_iterator rend(void)
+    {
+      return reverse_iterator{begin()};
+    }
+    
+    const_reverse_iterator rend(void) const
+    {
+      return const_reverse_iterator{begin()};
+    }
+    
+    const_reverse_iterator crend(void) const
+    {
+      return const_reverse_iterator{begin()};
+    }
+    
+    // Capacity
+    size_type size(void) const
+    {
+      return size_;
+    }
+    
+    size_type capacity(void) const
+    {
+      return capacity_;
+    }
+    
+    // true as long as we haven't spilled onto the heap
+    bool is_small(void) const
+    {
+      return is_inline();
+    }
+    
+    void reserve(size_type const count)
+    {
+      if (count > capacity_) {
+        auto const buf = allocate(count);
+        detail::relocate(data_, data_ + size_, buf);
+        release();
+        data_ = buf;
+        capacity_ = count;
+      }
+    }
+    
+    // Modifiers
+    iterator insert(const_iterator it, const_reference val)
+    {
+      return insert(it, 1, val);
+    }
+    
+    iterator insert(const_iterator it, size_type const count, const_reference val)
+    {
+      // val may live inside the buffer we're about to move away from
+      value_type const tmp{val};
+      auto const pos = make_room(it - cbegin(), count);
+      
+      try {
+        std::uninitialized_fill(pos, pos + count, tmp);
+      } catch (...) {
+        close_room(pos, count);
+        throw;
+      }
+      
+      size_ += count;
+      return pos;
+    }
+    
+    template <
+      typename InputIt,
+      typename = typename std::iterator_traits<InputIt>::iterator_category
+    >
+    iterator insert(const_iterator it, InputIt first, InputIt last)
+    {
+      return insert_range(
+        it, first, last,
+        typename std::iterator_traits<InputIt>::iterator_category{});
+    }
+    
+    iterator insert(const_iterator it, std::initializer_list<value_type> init)
+    {
+      return insert(it, init.begin(), init.end());
+    }
+    
+    template <typename Range>
+    void append_range(Range&& range)
+    {
+      using std::begin;
+      using std::end;
+      insert(cend(), begin(range), end(range));
+    }
+    
+    template <
+      typename InputIt,
+      typename = typename std::iterator_traits<InputIt>::iterator_category
+    >
+    void assign(InputIt first, InputIt last)
+    {
+      clear();
+      insert(cend(), first, last);
+    }
+    
+    void assign(std::initializer_list<value_type> init)
+    {
+      assign(init.begin(), init.end());
+    }
+    
+    void clear(void)
+    {
+      for (size_type i = 0; i < size_; ++i) {
+        (data_ + i)->~value_type();
+      }
+      size_ = 0;
+    }
+    
+    iterator erase(const_iterator it)
+    {
+      auto const pos = data_ + (it - cbegin());
+      pos->~value_type();
+      
+      detail::relocate(pos + 1, end(), pos);
+      
+      --size_;
+      return pos;
+    }
+    
+    template <typename ...Args>
+    void emplace_back(Args&& ...args)
+    {
+      if (size_ < capacity_) {
+        new(data_ + size_) value_type{std::forward<Args>(args)...};
+        ++size_;
+        return;
+      }
+      
+      // the arguments may refer to our own elements so the new one
+      // is built in the new buffer before the old ones are moved over
+      auto const new_capacity = grown_capacity(size_ + 1);
+      auto const buf = allocate(new_capacity);
+      
+      try {
+        new(buf + size_) value_type{std::forward<Args>(args)...};
+      } catch (...) {
+        std::allocator<value_type>{}.deallocate(buf, new_capacity);
+        throw;
+      }
+      
+      detail::relocate(data_, data_ + size_, buf);
+      release();
+      data_ = buf;
+      capacity_ = new_capacity;
+      ++size_;
+    }
+    
+    void pop_back(void)
+    {
+      (data_ + size_ - 1)->~value_type();
+      --size_;
+    }
+    
+    void resize(size_type const count)
+    {
+      if (count <= size_) {
+        truncate(count);
+        return;
+      }
+      
+      if (count > capacity_) {
+        reserve(grown_capacity(count));
+      }
+      
+      auto const first = data_ + size_;
+      auto const last = data_ + count;
+      auto ptr = first;
+      try {
+        for (; ptr != last; ++ptr) {
+          new(ptr) value_type{};
+        }
+      } catch (...) {
+        while (ptr != first) {
+          (--ptr)->~value_type();
+        }
+        throw;
+      }
+      size_ = count;
+    }
+    
+    void resize(size_type const count, const_reference val)
+    {
+      if (count <= size_) {
+        truncate(count);
+        return;
+      }
+      
+      // insert() copies val first and grows the same way emplace_back()
+      // does, so val may be one of our own elements
+      insert(cend(), count - size_, val);
+    }
+    
+    small_vector slice(size_type const pos)
+    {
+      small_vector dst;
+      dst.reserve(size_ - pos);
+      detail::relocate(data_ + pos, data_ + size_, dst.data_);
+      dst.size_ = size_ - pos;
+      size_ = pos;
+      return dst;
+    }
+  };
+  
+  template <typename T, std::size_t N>
+  void swap(small_vector<T, N>& a, small_vector<T, N>& b)
+    noexcept(noexcept(a.swap(b)))
+  {
+    a.swap(b);
+  }
+}
+
+#endif // REGULUS_SMALL_VECTOR_HPP_
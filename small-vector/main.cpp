@@ -0,0 +1,268 @@
+#include <cassert>
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <ctime>
+#include <vector>
+
+#include "./include/small-vector.hpp"
+
+using regulus::small_vector;
+
+namespace
+{
+  struct counted
+  {
+    static int alive;
+    int val;
+    
+    counted(int v = 0)
+      : val{v}
+    {
+      ++alive;
+    }
+    
+    counted(counted const& other)
+      : val{other.val}
+    {
+      ++alive;
+    }
+    
+    ~counted(void)
+    {
+      --alive;
+    }
+  };
+  
+  int counted::alive = 0;
+  
+  struct no_default
+  {
+    int val;
+    
+    explicit no_default(int const v)
+      : val{v}
+    {}
+  };
+  
+  // builds `count` vectors of varying small sizes, sums them up and
+  // throws them away again. this is the pattern small_vector is for.
+  template <typename Vector>
+  double run_benchmark(int const count, int const max_size, long long& sum)
+  {
+    auto begin = std::clock();
+    
+    for (int i = 0; i < count; ++i) {
+      Vector vec;
+      int const size = 1 + (i % max_size);
+      for (int j = 0; j < size; ++j) {
+        vec.emplace_back(j);
+      }
+      sum += std::accumulate(vec.begin(), vec.end(), 0LL);
+    }
+    
+    auto end = std::clock();
+    return double{(double ) end - begin} / CLOCKS_PER_SEC;
+  }
+}
+
+int main(void)
+{
+  // it should be default constructible and start out inline
+  {
+    small_vector<int, 16> vec;
+    assert(vec.size() == 0);
+    assert(vec.capacity() == 16);
+    assert(vec.is_small());
+  }
+  
+  // it should stay inline up to N elements
+  {
+    small_vector<int, 16> vec;
+    for (int i = 0; i < 16; ++i) {
+      vec.emplace_back(i);
+    }
+    
+    assert(vec.is_small());
+    assert(vec.size() == 16);
+    for (int i = 0; i < 16; ++i) {
+      assert(vec[i] == i);
+    }
+  }
+  
+  // it should spill onto the heap and keep growing
+  {
+    small_vector<int, 16> vec;
+    for (int i = 0; i < 1000; ++i) {
+      vec.emplace_back(i);
+    }
+    
+    assert(!vec.is_small());
+    assert(vec.size() == 1000);
+    assert(vec.capacity() >= 1000);
+    for (int i = 0; i < 1000; ++i) {
+      assert(vec[i] == i);
+    }
+  }
+  
+  // emplacing one of our own elements while growing should work
+  {
+    small_vector<int, 4> vec{1, 2, 3, 4};
+    vec.emplace_back(vec[0]);
+    assert(vec.size() == 5);
+    assert(vec.back() == 1);
+  }
+  
+  // it should be insert-able and erase-able across the spill
+  {
+    small_vector<int, 8> vec{0, 1, 2, 3, 4, 5, 6, 7};
+    
+    auto it = vec.insert(vec.begin() + 4, 1337);
+    assert(!vec.is_small());
+    assert(*it == 1337);
+    assert(vec.size() == 9);
+    
+    it = vec.erase(it);
+    assert(*it == 4);
+    for (int i = 0; i < 8; ++i) {
+      assert(vec[i] == i);
+    }
+    
+    int const src[] = {8, 9, 10, 11};
+    vec.insert(vec.end(), std::begin(src), std::end(src));
+    vec.insert(vec.begin(), 2, vec[0]);
+    assert(vec.size() == 14);
+    assert(vec[0] == 0 && vec[1] == 0 && vec[2] == 0);
+    assert(vec.back() == 11);
+  }
+  
+  // it should support slicing
+  {
+    small_vector<int, 8> vec;
+    for (int i = 0; i < 32; ++i) {
+      vec.emplace_back(i);
+    }
+    
+    auto chunk = vec.slice(4);
+    assert(vec.size() == 4);
+    assert(vec.is_small() == false);
+    assert(chunk.size() == 28);
+    
+    for (int i = 0; i < 28; ++i) {
+      assert(chunk[i] == i + 4);
+    }
+  }
+  
+  // copies and moves should work from both inline and heap storage
+  {
+    small_vector<int, 4> small{1, 2};
+    small_vector<int, 4> big{1, 2, 3, 4, 5, 6};
+    
+    auto small_copy = small;
+    auto big_copy = big;
+    assert(std::equal(small.begin(), small.end(), small_copy.begin()));
+    assert(std::equal(big.begin(), big.end(), big_copy.begin()));
+    
+    auto const big_data = big.data();
+    auto big_moved = std::move(big);
+    assert(big_moved.data() == big_data);
+    assert(big.size() == 0 && big.is_small());
+    
+    auto small_moved = std::move(small);
+    assert(small_moved.is_small());
+    assert(small_moved.size() == 2 && small_moved[1] == 2);
+    
+    small_moved.swap(big_moved);
+    assert(small_moved.size() == 6);
+    assert(big_moved.size() == 2);
+  }
+  
+  // it shouldn't leak or double-destroy anything
+  {
+    {
+      small_vector<counted, 4> vec;
+      for (int i = 0; i < 10; ++i) {
+        vec.emplace_back(i);
+      }
+      assert(counted::alive == 10);
+      
+      vec.insert(vec.begin(), counted{-1});
+      vec.erase(vec.begin() + 5);
+      assert(counted::alive == 10);
+      
+      auto copy = vec;
+      assert(counted::alive == 20);
+      
+      auto chunk = copy.slice(2);
+      assert(counted::alive == 20);
+      
+      copy = std::move(chunk);
+      assert(counted::alive == 18);
+      
+      vec.resize(2);
+      assert(counted::alive == 10);
+    }
+    assert(counted::alive == 0);
+  }
+  
+  // it should resize from a value without default constructing anything
+  {
+    small_vector<no_default, 4> vec;
+    vec.resize(3, no_default{7});
+    assert(vec.size() == 3 && vec.capacity() == 4 && vec[2].val == 7);
+    
+    vec.resize(5, vec[0]);
+    assert(vec.size() == 5 && vec[4].val == 7);
+    
+    // growing one at a time doesn't reallocate every time
+    auto const capacity = vec.capacity();
+    assert(capacity >= 8);
+    vec.resize(6, no_default{1});
+    vec.resize(7, no_default{2});
+    assert(vec.capacity() == capacity && vec[6].val == 2);
+    
+    vec.resize(2, no_default{0});
+    assert(vec.size() == 2 && vec[1].val == 7);
+    
+    small_vector<int, 4> ints;
+    ints.resize(5);
+    assert(ints.capacity() >= 8);
+  }
+  
+  // it should be STL-compatible
+  {
+    small_vector<int, 8> vec{5, 3, 1, 4, 2};
+    std::sort(vec.begin(), vec.end());
+    for (int i = 0; i < 5; ++i) {
+      assert(vec[i] == i + 1);
+    }
+    assert(*vec.rbegin() == 5);
+  }
+  
+  int const num_vectors = 1024 * 1024 * 4;
+  int const max_size = 16;
+  
+  long long my_sum = 0;
+  long long stl_sum = 0;
+  
+  double my_time = run_benchmark<small_vector<int, max_size>>(
+    num_vectors, max_size, my_sum);
+  double stl_time = run_benchmark<std::vector<int>>(
+    num_vectors, max_size, stl_sum);
+  
+  assert(my_sum == stl_sum);
+  
+  std::cout << "My time : " << my_time << std::endl;
+  std::cout << "STL time : " << stl_time << std::endl;
+  
+  // now with the occasional vector spilling onto the heap
+  my_time = run_benchmark<small_vector<int, max_size>>(
+    num_vectors, max_size * 2, my_sum);
+  stl_time = run_benchmark<std::vector<int>>(
+    num_vectors, max_size * 2, stl_sum);
+  
+  assert(my_sum == stl_sum);
+  
+  std::cout << "My time (spilling) : " << my_time << std::endl;
+  std::cout << "STL time (spilling) : " << stl_time << std::endl;
+}
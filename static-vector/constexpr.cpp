@@ -0,0 +1,138 @@
+#include <cassert>
+#include <algorithm>
+#include <string>
+
+#include "./include/static-vector.hpp"
+
+// built with C++20 so static_vector can be used in constant expressions
+
+static_assert(
+  REGULUS_CONSTEXPR_STATIC_VECTOR,
+  "C++20 builds should get a constexpr static_vector");
+
+namespace
+{
+  struct point
+  {
+    int x;
+    int y;
+  };
+  
+  constexpr regulus::static_vector<int, 16> make_squares(void)
+  {
+    regulus::static_vector<int, 16> vec;
+    for (int i = 0; i < 10; ++i) {
+      vec.emplace_back(i * i);
+    }
+    return vec;
+  }
+  
+  constexpr int sum(regulus::static_vector<int, 16> const& vec)
+  {
+    int total = 0;
+    for (auto const val : vec) {
+      total += val;
+    }
+    return total;
+  }
+  
+  constexpr bool modifiers_work(void)
+  {
+    regulus::static_vector<int, 16> vec{1, 2, 4, 5};
+    vec.insert(vec.begin() + 2, 3);
+    vec.insert(vec.begin(), 2, 0);
+    vec.insert(vec.end(), {6, 7});
+    vec.erase(vec.begin());
+    vec.emplace(vec.begin() + 1, vec[6]);
+    vec.pop_back();
+    
+    int const expected[] = {0, 6, 1, 2, 3, 4, 5, 6};
+    if (!std::equal(vec.begin(), vec.end(), std::begin(expected), std::end(expected))) {
+      return false;
+    }
+    
+    // val refers to an element that gets shifted
+    vec.insert(vec.begin(), vec.back());
+    vec.resize(12);
+    if (vec.front() != 6 || vec.size() != 12 || vec.back() != 0) {
+      return false;
+    }
+    
+    regulus::static_vector<int, 16> other{9, 9};
+    other.swap(vec);
+    auto moved = std::move(other);
+    vec = moved;
+    vec.splice(other, 0);
+    return vec.size() == 12 && moved.size() == 12 && other.size() == 0 && vec[0] == 6;
+  }
+  
+  constexpr bool erasing_works(void)
+  {
+    auto vec = make_squares();
+    vec.erase(vec.begin() + 1, vec.begin() + 3);
+    vec.erase_unordered(vec.begin());
+    auto const erased = vec.erase_if([](int const val) { return val % 2 == 0; });
+    
+    int const expected[] = {81, 9, 25, 49};
+    return
+      erased == 3 &&
+      std::equal(vec.begin(), vec.end(), std::begin(expected), std::end(expected));
+  }
+  
+  constexpr regulus::static_vector<point, 4> make_points(void)
+  {
+    regulus::static_vector<point, 4> vec;
+    vec.emplace_back(1, 2);
+    vec.emplace_back(3, 4);
+    return vec;
+  }
+  
+  // filled up and then cut back down, so slots past size() held
+  // elements that were erased
+  constexpr regulus::static_vector<int, 16> make_pruned(void)
+  {
+    auto vec = make_squares();
+    vec.erase_if([](int const val) { return val > 20; });
+    vec.pop_back();
+    return vec;
+  }
+  
+  // the table lives in read-only data, nothing runs at startup
+  constexpr auto squares = make_squares();
+  constexpr auto points = make_points();
+  
+  // partially filled and empty results leave slots past size() unused
+  constexpr auto pruned = make_pruned();
+  constexpr regulus::static_vector<int, 8> nothing{};
+}
+
+int main(void)
+{
+  // it should be usable in constant expressions
+  {
+    static_assert(squares.size() == 10);
+    static_assert(squares[9] == 81);
+    static_assert(sum(squares) == 285);
+    static_assert(modifiers_work());
+    static_assert(erasing_works());
+    static_assert(points.back().y == 4);
+    static_assert(pruned.size() == 4 && pruned.back() == 9);
+    static_assert(nothing.size() == 0 && nothing.capacity() == 8);
+  }
+  
+  // it should still work the same at runtime
+  {
+    assert(modifiers_work());
+    assert(erasing_works());
+    
+    auto vec = squares;
+    vec.erase(vec.begin());
+    assert(vec.size() == 9 && vec.front() == 1);
+    
+    regulus::static_vector<std::string, 4> strs{"a", "b"};
+    strs.insert(strs.begin(), strs.back());
+    assert(strs.size() == 3 && strs[0] == "b" && strs[2] == "b");
+  }
+  
+  return 0;
+}
@@ -0,0 +1,578 @@
+#ifndef REGULUS_SIMD_ALGORITHM_HPP_
+#define REGULUS_SIMD_ALGORITHM_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+#include "static-vector.hpp"
+
+/**
+  * Explicitly vectorized find, count, min_element, max_element,
+  * accumulate and contains over contiguous ranges of 32 and 64 bit
+  * integers, floats and doubles. The widest of SSE2, AVX2 and AVX-512
+  * the CPU supports gets picked at runtime, so the binary doesn't need
+  * to be built for a particular machine. Any other type, compiler or
+  * architecture just gets the std algorithms.
+  *
+  * Results match the std algorithms with two exceptions: accumulate
+  * adds floating point numbers in a different order, and min_element
+  * and max_element aren't guaranteed to return the same element as
+  * std when the range holds a NaN. Like std::accumulate, accumulate
+  * sums in the type of init; only when that's the element type itself
+  * do the kernels get to do the adding.
+  *
+  * Define REGULUS_SIMD as 0 to turn the kernels off altogether.
+  */
+#ifndef REGULUS_SIMD
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define REGULUS_SIMD 1
+#else
+#define REGULUS_SIMD 0
+#endif
+#endif
+
+namespace regulus
+{
+  namespace simd
+  {
+    enum class simd_level
+    {
+      scalar,
+      sse2,
+      avx2,
+      avx512
+    };
+    
+    // what this CPU can do, checked once
+    inline simd_level detected_level(void)
+    {
+#if REGULUS_SIMD
+      static simd_level const level = []
+      {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") &&
+            __builtin_cpu_supports("avx512bw") &&
+            __builtin_cpu_supports("avx512dq") &&
+            __builtin_cpu_supports("avx512vl")) {
+          return simd_level::avx512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+          return simd_level::avx2;
+        }
+        return simd_level::sse2;
+      }();
+      return level;
+#else
+      return simd_level::scalar;
+#endif
+    }
+    
+    namespace detail
+    {
+      template <typename T>
+      struct is_simd_type
+        : std::integral_constant<
+            bool,
+            std::is_same<T, std::int32_t>::value ||
+            std::is_same<T, std::uint32_t>::value ||
+            std::is_same<T, std::int64_t>::value ||
+            std::is_same<T, std::uint64_t>::value ||
+            std::is_same<T, float>::value ||
+            std::is_same<T, double>::value>
+      {};
+      
+      // scalar versions, also what every kernel falls back on
+      struct scalar_kernels
+      {
+        template <typename T>
+        static T const* find(T const* first, T const* last, T const& val)
+        {
+          return std::find(first, last, val);
+        }
+        
+        template <typename T>
+        static std::size_t count(T const* first, T const* last, T const& val)
+        {
+          return std::count(first, last, val);
+        }
+        
+        template <typename T>
+        static T min_value(T const* first, T const* last)
+        {
+          return *std::min_element(first, last);
+        }
+        
+        template <typename T>
+        static T max_value(T const* first, T const* last)
+        {
+          return *std::max_element(first, last);
+        }
+        
+        template <typename T, typename U>
+        static U accumulate(T const* first, T const* last, U init)
+        {
+          return std::accumulate(first, last, std::move(init));
+        }
+      };
+
+#if REGULUS_SIMD
+      /**
+        * The kernels are written once with GCC vector types and forced
+        * inline into the entry points below, which compiles them with
+        * whatever instruction set the entry point targets. Each loop
+        * keeps a few vectors in flight so consecutive iterations don't
+        * wait on each other, the leftovers go through a scalar loop.
+        */
+      template <typename T, std::size_t Bytes>
+      struct vector_of
+      {
+        typedef T type __attribute__((vector_size(Bytes)));
+      };
+      
+      template <std::size_t Bytes, typename T>
+      __attribute__((always_inline))
+      inline T const* find_kernel(T const* first, T const* last, T const val)
+      {
+        typedef typename vector_of<T, Bytes>::type vector;
+        typedef typename vector_of<long long, 16>::type half;
+        std::ptrdiff_t const lanes = Bytes / sizeof(T);
+        
+        vector const needle = vector{} + val;
+        for (; last - first >= 4 * lanes; first += 4 * lanes) {
+          vector a, b, c, d;
+          std::memcpy(&a, first, Bytes);
+          std::memcpy(&b, first + lanes, Bytes);
+          std::memcpy(&c, first + 2 * lanes, Bytes);
+          std::memcpy(&d, first + 3 * lanes, Bytes);
+          
+          // adding the masks up instead of or-ing them keeps GCC from
+          // taking AVX-512 compares apart into scalar code
+          auto const hits = (a == needle) + (b == needle) + (c == needle) + (d == needle);
+          
+          half parts[Bytes / 16];
+          std::memcpy(parts, &hits, Bytes);
+          for (std::size_t i = 1; i < Bytes / 16; ++i) {
+            parts[0] |= parts[i];
+          }
+          if ((parts[0][0] | parts[0][1]) != 0) {
+            break;
+          }
+        }
+        
+        for (; first != last; ++first) {
+          if (*first == val) {
+            return first;
+          }
+        }
+        return last;
+      }
+      
+      template <std::size_t Bytes, typename T>
+      __attribute__((always_inline))
+      inline std::size_t count_kernel(T const* first, T const* last, T const val)
+      {
+        typedef typename vector_of<T, Bytes>::type vector;
+        std::ptrdiff_t const lanes = Bytes / sizeof(T);
+        
+        // a match is a lane of all ones, so subtracting counts it
+        vector const needle = vector{} + val;
+        decltype(needle == needle) total0{}, total1{};
+        for (; last - first >= 2 * lanes; first += 2 * lanes) {
+          vector a, b;
+          std::memcpy(&a, first, Bytes);
+          std::memcpy(&b, first + lanes, Bytes);
+          total0 -= a == needle;
+          total1 -= b == needle;
+        }
+        total0 += total1;
+        
+        std::size_t total = 0;
+        for (std::ptrdiff_t i = 0; i < lanes; ++i) {
+          total += total0[i];
+        }
+        for (; first != last; ++first) {
+          total += *first == val;
+        }
+        return total;
+      }
+      
+      // the smallest element or with Max the largest, first != last
+      template <std::size_t Bytes, bool Max, typename T>
+      __attribute__((always_inline))
+      inline T extreme_kernel(T const* first, T const* last)
+      {
+        typedef typename vector_of<T, Bytes>::type vector;
+        std::ptrdiff_t const lanes = Bytes / sizeof(T);
+        
+        T best = *first;
+        if (last - first >= 2 * lanes) {
+          vector best0, best1;
+          std::memcpy(&best0, first, Bytes);
+          std::memcpy(&best1, first + lanes, Bytes);
+          first += 2 * lanes;
+          
+          for (; last - first >= 2 * lanes; first += 2 * lanes) {
+            vector a, b;
+            std::memcpy(&a, first, Bytes);
+            std::memcpy(&b, first + lanes, Bytes);
+            if (Max) {
+              best0 = best0 < a ? a : best0;
+              best1 = best1 < b ? b : best1;
+            } else {
+              best0 = a < best0 ? a : best0;
+              best1 = b < best1 ? b : best1;
+            }
+          }
+          
+          for (std::ptrdiff_t i = 0; i < lanes; ++i) {
+            if (Max ? best < best0[i] : best0[i] < best) {
+              best = best0[i];
+            }
+            if (Max ? best < best1[i] : best1[i] < best) {
+              best = best1[i];
+            }
+          }
+        }
+        
+        for (; first != last; ++first) {
+          if (Max ? best < *first : *first < best) {
+            best = *first;
+          }
+        }
+        return best;
+      }
+      
+      template <std::size_t Bytes, typename T>
+      __attribute__((always_inline))
+      inline T accumulate_kernel(T const* first, T const* last, T init)
+      {
+        typedef typename vector_of<T, Bytes>::type vector;
+        std::ptrdiff_t const lanes = Bytes / sizeof(T);
+        
+        vector sum0{}, sum1{}, sum2{}, sum3{};
+        for (; last - first >= 4 * lanes; first += 4 * lanes) {
+          vector a, b, c, d;
+          std::memcpy(&a, first, Bytes);
+          std::memcpy(&b, first + lanes, Bytes);
+          std::memcpy(&c, first + 2 * lanes, Bytes);
+          std::memcpy(&d, first + 3 * lanes, Bytes);
+          sum0 += a;
+          sum1 += b;
+          sum2 += c;
+          sum3 += d;
+        }
+        sum0 += sum1;
+        sum2 += sum3;
+        sum0 += sum2;
+        
+        for (std::ptrdiff_t i = 0; i < lanes; ++i) {
+          init += sum0[i];
+        }
+        for (; first != last; ++first) {
+          init += *first;
+        }
+        return init;
+      }
+      
+      /**
+        * SSE2 is part of every x86-64 CPU so these need no target.
+        * It can't compare 64 bit integers though, which leaves those
+        * to the scalar loops for everything but accumulate.
+        */
+      struct sse2_kernels
+      {
+        template <typename T>
+        using compares = std::integral_constant<
+          bool, !(std::is_integral<T>::value && sizeof(T) == 8)>;
+        
+        template <typename T>
+        static T const* find(T const* first, T const* last, T const val)
+        {
+          return compares<T>::value ?
+            find_kernel<16>(first, last, val) :
+            scalar_kernels::find(first, last, val);
+        }
+        
+        template <typename T>
+        static std::size_t count(T const* first, T const* last, T const val)
+        {
+          return compares<T>::value ?
+            count_kernel<16>(first, last, val) :
+            scalar_kernels::count(first, last, val);
+        }
+        
+        template <typename T>
+        static T min_value(T const* first, T const* last)
+        {
+          return compares<T>::value ?
+            extreme_kernel<16, false>(first, last) :
+            scalar_kernels::min_value(first, last);
+        }
+        
+        template <typename T>
+        static T max_value(T const* first, T const* last)
+        {
+          return compares<T>::value ?
+            extreme_kernel<16, true>(first, last) :
+            scalar_kernels::max_value(first, last);
+        }
+        
+        template <typename T>
+        static T accumulate(T const* first, T const* last, T const init)
+        {
+          return accumulate_kernel<16>(first, last, init);
+        }
+      };
+      
+      struct avx2_kernels
+      {
+        template <typename T>
+        __attribute__((target("avx2")))
+        static T const* find(T const* first, T const* last, T const val)
+        {
+          return find_kernel<32>(first, last, val);
+        }
+        
+        template <typename T>
+        __attribute__((target("avx2")))
+        static std::size_t count(T const* first, T const* last, T const val)
+        {
+          return count_kernel<32>(first, last, val);
+        }
+        
+        template <typename T>
+        __attribute__((target("avx2")))
+        static T min_value(T const* first, T const* last)
+        {
+          return extreme_kernel<32, false>(first, last);
+        }
+        
+        template <typename T>
+        __attribute__((target("avx2")))
+        static T max_value(T const* first, T const* last)
+        {
+          return extreme_kernel<32, true>(first, last);
+        }
+        
+        template <typename T>
+        __attribute__((target("avx2")))
+        static T accumulate(T const* first, T const* last, T const init)
+        {
+          return accumulate_kernel<32>(first, last, init);
+        }
+      };
+      
+      // GCC only turns 512 bit vector code into decent AVX-512 with
+      // the BW, DQ and VL extensions on top of the foundation
+      struct avx512_kernels
+      {
+        template <typename T>
+        __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl")))
+        static T const* find(T const* first, T const* last, T const val)
+        {
+          return find_kernel<64>(first, last, val);
+        }
+        
+        template <typename T>
+        __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl")))
+        static std::size_t count(T const* first, T const* last, T const val)
+        {
+          return count_kernel<64>(first, last, val);
+        }
+        
+        template <typename T>
+        __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl")))
+        static T min_value(T const* first, T const* last)
+        {
+          return extreme_kernel<64, false>(first, last);
+        }
+        
+        template <typename T>
+        __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl")))
+        static T max_value(T const* first, T const* last)
+        {
+          return extreme_kernel<64, true>(first, last);
+        }
+        
+        template <typename T>
+        __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl")))
+        static T accumulate(T const* first, T const* last, T const init)
+        {
+          return accumulate_kernel<64>(first, last, init);
+        }
+      };
+#endif
+      
+      /**
+        * Hands the call to the kernels for level, which has to be
+        * supported by the CPU. op gets called with the kernel struct,
+        * types the kernels don't handle always get the scalar ones.
+        */
+      template <typename F>
+      auto dispatch(simd_level const level, F op, std::false_type)
+      {
+        (void) level;
+        return op(scalar_kernels{});
+      }
+      
+      template <typename F>
+      auto dispatch(simd_level const level, F op, std::true_type)
+      {
+#if REGULUS_SIMD
+        switch (level) {
+          case simd_level::avx512:
+            return op(avx512_kernels{});
+          case simd_level::avx2:
+            return op(avx2_kernels{});
+          case simd_level::sse2:
+            return op(sse2_kernels{});
+          case simd_level::scalar:
+            break;
+        }
+#else
+        (void) level;
+#endif
+        return op(scalar_kernels{});
+      }
+      
+      // keeps a parameter out of template argument deduction
+      template <typename T>
+      struct identity
+      {
+        typedef T type;
+      };
+      
+      template <typename T>
+      using identity_t = typename identity<T>::type;
+      
+      // the lanes add in T, so summing in anything else is left to std
+      template <typename T, typename U>
+      using sums_in_lanes = std::integral_constant<
+        bool, is_simd_type<T>::value && std::is_same<T, U>::value>;
+    }
+    
+    /**
+      * The pointer range versions. Passing a level picks a particular
+      * set of kernels instead of the best one, mostly for testing and
+      * benchmarking; it mustn't be above detected_level().
+      */
+    template <typename T>
+    T const* find(
+      T const* first, T const* last, detail::identity_t<T> const& val,
+      simd_level const level = detected_level())
+    {
+      return detail::dispatch(level, [&](auto kernels)
+      {
+        return kernels.find(first, last, val);
+      }, detail::is_simd_type<T>{});
+    }
+    
+    template <typename T>
+    bool contains(
+      T const* first, T const* last, detail::identity_t<T> const& val,
+      simd_level const level = detected_level())
+    {
+      return simd::find(first, last, val, level) != last;
+    }
+    
+    template <typename T>
+    std::size_t count(
+      T const* first, T const* last, detail::identity_t<T> const& val,
+      simd_level const level = detected_level())
+    {
+      return detail::dispatch(level, [&](auto kernels)
+      {
+        return kernels.count(first, last, val);
+      }, detail::is_simd_type<T>{});
+    }
+    
+    // the kernels find the value and then where it first shows up,
+    // a NaN can make the second step miss in which case std decides
+    template <typename T>
+    T const* min_element(
+      T const* first, T const* last,
+      simd_level const level = detected_level())
+    {
+      if (!detail::is_simd_type<T>::value || first == last) {
+        return std::min_element(first, last);
+      }
+      auto const min = detail::dispatch(level, [&](auto kernels)
+      {
+        return kernels.min_value(first, last);
+      }, detail::is_simd_type<T>{});
+      auto const it = simd::find(first, last, min, level);
+      return it != last ? it : std::min_element(first, last);
+    }
+    
+    template <typename T>
+    T const* max_element(
+      T const* first, T const* last,
+      simd_level const level = detected_level())
+    {
+      if (!detail::is_simd_type<T>::value || first == last) {
+        return std::max_element(first, last);
+      }
+      auto const max = detail::dispatch(level, [&](auto kernels)
+      {
+        return kernels.max_value(first, last);
+      }, detail::is_simd_type<T>{});
+      auto const it = simd::find(first, last, max, level);
+      return it != last ? it : std::max_element(first, last);
+    }
+    
+    template <typename T, typename U>
+    U accumulate(
+      T const* first, T const* last, U init,
+      simd_level const level = detected_level())
+    {
+      return detail::dispatch(level, [&](auto kernels)
+      {
+        return kernels.accumulate(first, last, std::move(init));
+      }, detail::sums_in_lanes<T, U>{});
+    }
+    
+    // static_vector versions, they return const iterators
+    template <typename T, std::size_t N>
+    T const* find(static_vector<T, N> const& vec, detail::identity_t<T> const& val)
+    {
+      return simd::find(vec.begin(), vec.end(), val);
+    }
+    
+    template <typename T, std::size_t N>
+    bool contains(static_vector<T, N> const& vec, detail::identity_t<T> const& val)
+    {
+      return simd::contains(vec.begin(), vec.end(), val);
+    }
+    
+    template <typename T, std::size_t N>
+    std::size_t count(static_vector<T, N> const& vec, detail::identity_t<T> const& val)
+    {
+      return simd::count(vec.begin(), vec.end(), val);
+    }
+    
+    template <typename T, std::size_t N>
+    T const* min_element(static_vector<T, N> const& vec)
+    {
+      return simd::min_element(vec.begin(), vec.end());
+    }
+    
+    template <typename T, std::size_t N>
+    T const* max_element(static_vector<T, N> const& vec)
+    {
+      return simd::max_element(vec.begin(), vec.end());
+    }
+    
+    template <typename T, std::size_t N, typename U>
+    U accumulate(static_vector<T, N> const& vec, U init)
+    {
+      return simd::accumulate(vec.begin(), vec.end(), std::move(init));
+    }
+  }
+}
+
+#endif // REGULUS_SIMD_ALGORITHM_HPP_
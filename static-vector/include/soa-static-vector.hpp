@@ -0,0 +1,635 @@
+#ifndef REGULUS_SOA_STATIC_VECTOR_HPP_
+#define REGULUS_SOA_STATIC_VECTOR_HPP_
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "static-vector.hpp"
+
+namespace regulus
+{
+  namespace detail
+  {
+    /**
+      * Where each column of a soa_static_vector starts in its buffer.
+      * Every column begins on a cache line of its own so a scan over
+      * one of them never drags in bytes of another.
+      */
+    template <std::size_t N, typename ...Ts>
+    struct soa_layout
+    {
+      static constexpr std::size_t alignment = 64;
+      
+      static constexpr std::size_t offset(std::size_t const column)
+      {
+        std::size_t const sizes[] = {sizeof(Ts)...};
+        std::size_t offset = 0;
+        for (std::size_t i = 0; i < column; ++i) {
+          offset += sizes[i] * N;
+          offset = (offset + alignment - 1) / alignment * alignment;
+        }
+        return offset;
+      }
+      
+      static constexpr std::size_t size = offset(sizeof...(Ts));
+    };
+  }
+  
+  /**
+    * A static_vector of records that stores every field in a column
+    * of its own, structure-of-arrays style. Iterating gives proxy
+    * references to whole records, column<I>() gives a contiguous view
+    * of one field so scans that only read that field stay dense.
+    */
+  template <std::size_t N, typename ...Ts>
+  class soa_static_vector
+  {
+  public:
+    typedef std::tuple<Ts...> value_type;
+    typedef std::size_t       size_type;
+    typedef std::ptrdiff_t    difference_type;
+    
+    template <std::size_t I>
+    using column_type = std::tuple_element_t<I, value_type>;
+    
+    std::size_t const static column_count = sizeof...(Ts);
+    
+    static_assert(column_count > 0, "Records need at least one field");
+  
+  private:
+    typedef detail::soa_layout<N, Ts...> layout;
+    typedef std::index_sequence_for<Ts...> columns;
+    
+    // keeps pack expansions with side effects in order
+    typedef int expand[];
+  
+  public:
+    // a plain pointer range over the first size() slots of one column
+    template <typename T>
+    class column_span
+    {
+    private:
+      T*        data_;
+      size_type size_;
+    
+    public:
+      column_span(T* data, size_type const size)
+        : data_{data}
+        , size_{size}
+      {}
+      
+      T* begin(void) const
+      {
+        return data_;
+      }
+      
+      T* end(void) const
+      {
+        return data_ + size_;
+      }
+      
+      T* data(void) const
+      {
+        return data_;
+      }
+      
+      size_type size(void) const
+      {
+        return size_;
+      }
+      
+      T& operator[](size_type const pos) const
+      {
+        return data_[pos];
+      }
+    };
+    
+    /**
+      * Stands in for a record. It reads and writes the fields in
+      * place, converts to a value_type copy and assigning to it
+      * assigns every field.
+      */
+    template <bool Const>
+    class basic_reference
+    {
+    private:
+      typedef std::conditional_t<Const, soa_static_vector const, soa_static_vector>
+        vector_type;
+      
+      vector_type* vec_;
+      size_type    pos_;
+      
+      template <std::size_t ...Is>
+      value_type load(std::index_sequence<Is...>) const
+      {
+        return value_type{get<Is>()...};
+      }
+      
+      template <typename Tuple, std::size_t ...Is>
+      void store(Tuple const& val, std::index_sequence<Is...>) const
+      {
+        (void) expand{0, (get<Is>() = std::get<Is>(val), 0)...};
+      }
+      
+      template <bool OtherConst, std::size_t ...Is>
+      void store(basic_reference<OtherConst> const& other, std::index_sequence<Is...>) const
+      {
+        (void) expand{0, (get<Is>() = other.template get<Is>(), 0)...};
+      }
+      
+      template <std::size_t ...Is>
+      void swap_with(basic_reference const& other, std::index_sequence<Is...>) const
+      {
+        using std::swap;
+        (void) expand{0, (swap(get<Is>(), other.template get<Is>()), 0)...};
+      }
+    
+    public:
+      basic_reference(vector_type* vec, size_type const pos)
+        : vec_{vec}
+        , pos_{pos}
+      {}
+      
+      basic_reference(basic_reference const&) = default;
+      
+      template <std::size_t I>
+      decltype(auto) get(void) const
+      {
+        return vec_->template column<I>()[pos_];
+      }
+      
+      operator value_type(void) const
+      {
+        return load(columns{});
+      }
+      
+      basic_reference const& operator=(value_type const& val) const
+      {
+        store(val, columns{});
+        return *this;
+      }
+      
+      basic_reference const& operator=(basic_reference const& other) const
+      {
+        store(other, columns{});
+        return *this;
+      }
+      
+      template <bool OtherConst>
+      basic_reference const& operator=(basic_reference<OtherConst> const& other) const
+      {
+        store(other, columns{});
+        return *this;
+      }
+      
+      friend void swap(basic_reference a, basic_reference b)
+      {
+        a.swap_with(b, columns{});
+      }
+    };
+    
+    typedef basic_reference<false> reference;
+    typedef basic_reference<true>  const_reference;
+    
+    template <bool Const>
+    class basic_iterator :
+      public std::iterator<
+        std::random_access_iterator_tag, value_type,
+        difference_type, void, basic_reference<Const>>
+    {
+    private:
+      friend class soa_static_vector;
+      
+      template <bool>
+      friend class basic_iterator;
+      
+      typedef std::conditional_t<Const, soa_static_vector const, soa_static_vector>
+        vector_type;
+      
+      vector_type* vec_;
+      size_type    pos_;
+    
+    public:
+      basic_iterator(vector_type* vec, size_type const pos)
+        : vec_{vec}
+        , pos_{pos}
+      {}
+      
+      // iterators convert to const_iterators
+      template <
+        bool OtherConst,
+        typename = std::enable_if_t<Const && !OtherConst>
+      >
+      basic_iterator(basic_iterator<OtherConst> const& other)
+        : vec_{other.vec_}
+        , pos_{other.pos_}
+      {}
+      
+      basic_reference<Const> operator*(void) const
+      {
+        return basic_reference<Const>{vec_, pos_};
+      }
+      
+      basic_reference<Const> operator[](difference_type const n) const
+      {
+        return basic_reference<Const>{vec_, pos_ + n};
+      }
+      
+      basic_iterator& operator++(void)
+      {
+        ++pos_;
+        return *this;
+      }
+      
+      basic_iterator operator++(int)
+      {
+        auto tmp = *this;
+        ++pos_;
+        return tmp;
+      }
+      
+      basic_iterator& operator--(void)
+      {
+        --pos_;
+        return *this;
+      }
+      
+      basic_iterator operator--(int)
+      {
+        auto tmp = *this;
+        --pos_;
+        return tmp;
+      }
+      
+      basic_iterator& operator+=(difference_type const n)
+      {
+        pos_ += n;
+        return *this;
+      }
+      
+      basic_iterator& operator-=(difference_type const n)
+      {
+        pos_ -= n;
+        return *this;
+      }
+      
+      basic_iterator operator+(difference_type const n) const
+      {
+        return basic_iterator{vec_, pos_ + n};
+      }
+      
+      basic_iterator operator-(difference_type const n) const
+      {
+        return basic_iterator{vec_, pos_ - n};
+      }
+      
+      difference_type operator-(basic_iterator const& other) const
+      {
+        return (difference_type ) pos_ - (difference_type ) other.pos_;
+      }
+      
+      bool operator==(basic_iterator const& other) const
+      {
+        return pos_ == other.pos_;
+      }
+      
+      bool operator!=(basic_iterator const& other) const
+      {
+        return pos_ != other.pos_;
+      }
+      
+      bool operator<(basic_iterator const& other) const
+      {
+        return pos_ < other.pos_;
+      }
+      
+      bool operator>(basic_iterator const& other) const
+      {
+        return pos_ > other.pos_;
+      }
+      
+      bool operator<=(basic_iterator const& other) const
+      {
+        return pos_ <= other.pos_;
+      }
+      
+      bool operator>=(basic_iterator const& other) const
+      {
+        return pos_ >= other.pos_;
+      }
+    };
+    
+    typedef basic_iterator<false> iterator;
+    typedef basic_iterator<true>  const_iterator;
+  
+  private:
+    alignas(layout::alignment) unsigned char data_[layout::size];
+    detail::smallest_size_t<N>               size_;
+    
+    template <std::size_t I>
+    column_type<I>* column_data(void)
+    {
+      return reinterpret_cast<column_type<I>*>(data_ + layout::offset(I));
+    }
+    
+    template <std::size_t I>
+    column_type<I> const* column_data(void) const
+    {
+      return reinterpret_cast<column_type<I> const*>(data_ + layout::offset(I));
+    }
+    
+    void check_capacity(size_type const count) const
+    {
+      if (count > N - size_) {
+        throw std::length_error{"Capacity exceeded!"};
+      }
+    }
+    
+    // constructs the fields of slot pos from vals, a field that throws
+    // takes the ones before it down with it
+    template <std::size_t I, typename U, typename ...Us>
+    void construct_fields(size_type const pos, U&& val, Us&& ...rest)
+    {
+      auto const ptr = column_data<I>() + pos;
+      new(ptr) column_type<I>(std::forward<U>(val));
+      try {
+        construct_fields<I + 1>(pos, std::forward<Us>(rest)...);
+      } catch (...) {
+        ptr->~column_type<I>();
+        throw;
+      }
+    }
+    
+    template <std::size_t I>
+    void construct_fields(size_type const)
+    {}
+    
+    template <std::size_t ...Is>
+    void construct_default(size_type const pos, std::index_sequence<Is...>)
+    {
+      construct_fields<0>(pos, column_type<Is>{}...);
+    }
+    
+    template <typename Vector, std::size_t ...Is>
+    void construct_from(
+      size_type const pos, Vector&& other, size_type const other_pos,
+      std::index_sequence<Is...>)
+    {
+      construct_fields<0>(
+        pos,
+        std::move_if_noexcept(
+          std::forward<Vector>(other).template column_data<Is>()[other_pos])...);
+    }
+    
+    template <typename Tuple, std::size_t ...Is>
+    void construct_tuple(size_type const pos, Tuple&& val, std::index_sequence<Is...>)
+    {
+      construct_fields<0>(pos, std::get<Is>(std::forward<Tuple>(val))...);
+    }
+    
+    template <std::size_t ...Is>
+    void destroy_fields(size_type const pos, std::index_sequence<Is...>)
+    {
+      (void) expand{0, ((column_data<Is>() + pos)->~column_type<Is>(), 0)...};
+    }
+    
+    // closes the gap at pos, every column in a single relocation
+    template <std::size_t ...Is>
+    void close_gap(size_type const pos, std::index_sequence<Is...>)
+    {
+      (void) expand{0, (detail::relocate(
+        column_data<Is>() + pos + 1,
+        column_data<Is>() + size_,
+        column_data<Is>() + pos), 0)...};
+    }
+    
+    template <typename Vector>
+    void append_from(Vector&& other)
+    {
+      for (size_type i = 0; i < other.size_; ++i) {
+        construct_from(size_, std::forward<Vector>(other), i, columns{});
+        ++size_;
+      }
+    }
+  
+  public:
+    soa_static_vector(void)
+      : size_{0}
+    {}
+    
+    soa_static_vector(soa_static_vector const& other)
+      : size_{0}
+    {
+      append_from(other);
+    }
+    
+    soa_static_vector(soa_static_vector&& other)
+      : size_{0}
+    {
+      append_from(std::move(other));
+    }
+    
+    soa_static_vector& operator=(soa_static_vector const& other)
+    {
+      if (this != std::addressof(other)) {
+        clear();
+        append_from(other);
+      }
+      return *this;
+    }
+    
+    soa_static_vector& operator=(soa_static_vector&& other)
+    {
+      if (this != std::addressof(other)) {
+        clear();
+        append_from(std::move(other));
+      }
+      return *this;
+    }
+    
+    ~soa_static_vector(void)
+    {
+      clear();
+    }
+    
+    // Columns
+    template <std::size_t I>
+    column_span<column_type<I>> column(void)
+    {
+      return column_span<column_type<I>>{column_data<I>(), size_};
+    }
+    
+    template <std::size_t I>
+    column_span<column_type<I> const> column(void) const
+    {
+      return column_span<column_type<I> const>{column_data<I>(), size_};
+    }
+    
+    // Element Access
+    reference at(size_type const pos)
+    {
+      if (pos >= size_) {
+        throw std::out_of_range{"Index is out of bounds!"};
+      }
+      return this->operator[](pos);
+    }
+    
+    const_reference at(size_type const pos) const
+    {
+      if (pos >= size_) {
+        throw std::out_of_range{"Index is out of bounds!"};
+      }
+      return this->operator[](pos);
+    }
+    
+    reference operator[](size_type const pos)
+    {
+      return reference{this, pos};
+    }
+    
+    const_reference operator[](size_type const pos) const
+    {
+      return const_reference{this, pos};
+    }
+    
+    reference front(void)
+    {
+      return this->operator[](0);
+    }
+    
+    const_reference front(void) const
+    {
+      return this->operator[](0);
+    }
+    
+    reference back(void)
+    {
+      return this->operator[](size_ - 1);
+    }
+    
+    const_reference back(void) const
+    {
+      return this->operator[](size_ - 1);
+    }
+    
+    // Iterators
+    iterator begin(void)
+    {
+      return iterator{this, 0};
+    }
+    
+    const_iterator begin(void) const
+    {
+      return const_iterator{this, 0};
+    }
+    
+    const_iterator cbegin(void) const
+    {
+      return begin();
+    }
+    
+    iterator end(void)
+    {
+      return iterator{this, size_};
+    }
+    
+    const_iterator end(void) const
+    {
+      return const_iterator{this, size_};
+    }
+    
+    const_iterator cend(void) const
+    {
+      return end();
+    }
+    
+    // Capacity
+    bool empty(void) const
+    {
+      return size_ == 0;
+    }
+    
+    size_type size(void) const
+    {
+      return size_;
+    }
+    
+    size_type max_size(void) const
+    {
+      return N;
+    }
+    
+    size_type capacity(void) const
+    {
+      return N;
+    }
+    
+    // Modifiers
+    void clear(void)
+    {
+      while (size_ > 0) {
+        pop_back();
+      }
+    }
+    
+    // takes one argument per field
+    template <typename ...Us>
+    void emplace_back(Us&& ...vals)
+    {
+      static_assert(sizeof...(Us) == column_count, "Every field needs a value");
+      construct_fields<0>(size_, std::forward<Us>(vals)...);
+      ++size_;
+    }
+    
+    void push_back(value_type const& val)
+    {
+      construct_tuple(size_, val, columns{});
+      ++size_;
+    }
+    
+    void push_back(value_type&& val)
+    {
+      construct_tuple(size_, std::move(val), columns{});
+      ++size_;
+    }
+    
+    void pop_back(void)
+    {
+      destroy_fields(size_ - 1, columns{});
+      --size_;
+    }
+    
+    iterator erase(const_iterator it)
+    {
+      auto const pos = it.pos_;
+      destroy_fields(pos, columns{});
+      close_gap(pos, columns{});
+      --size_;
+      return iterator{this, pos};
+    }
+    
+    // new records get value-initialized fields
+    void resize(size_type const count)
+    {
+      if (count <= size_) {
+        while (size_ > count) {
+          pop_back();
+        }
+        return;
+      }
+      
+      check_capacity(count - size_);
+      while (size_ < count) {
+        construct_default(size_, columns{});
+        ++size_;
+      }
+    }
+  };
+}
+
+#endif // REGULUS_SOA_STATIC_VECTOR_HPP_
@@ -1,9 +1,130 @@
 #include <cassert>
 #include <algorithm>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <cstring>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include "./include/static-vector.hpp"
+#include "./include/simd-algorithm.hpp"
+#include "./include/soa-static-vector.hpp"
+
+namespace
+{
+  // keeps track of how many instances are alive so we can
+  // tell if the vector leaks or double-destroys anything
+  struct counted
+  {
+    static int alive;
+    int val;
+    
+    counted(int v = 0)
+      : val{v}
+    {
+      ++alive;
+    }
+    
+    counted(counted const& other)
+      : val{other.val}
+    {
+      ++alive;
+    }
+    
+    ~counted(void)
+    {
+      --alive;
+    }
+  };
+  
+  int counted::alive = 0;
+  
+  // only ever constructed from a value, never default constructed
+  struct no_default
+  {
+    int val;
+    
+    explicit no_default(int v)
+      : val{v}
+    {}
+  };
+  
+  // a type that isn't trivially copyable but is still safe
+  // to move around with memcpy
+  struct relocatable
+  {
+    int val;
+    
+    relocatable(int v)
+      : val{v}
+    {}
+    
+    relocatable(relocatable const& other)
+      : val{other.val}
+    {}
+  };
+  
+  // compares every simd kernel the CPU supports against std on
+  // ranges of every length up to 300 and at every alignment
+  template <typename T>
+  void check_simd_kernels(void)
+  {
+    using regulus::simd::simd_level;
+    
+    std::mt19937 gen{17};
+    regulus::static_vector<T, 320> vec;
+    for (int i = 0; i < 320; ++i) {
+      vec.emplace_back((T ) (gen() % 50));
+    }
+    
+    simd_level const levels[] = {
+      simd_level::scalar, simd_level::sse2, simd_level::avx2, simd_level::avx512};
+    
+    for (auto const level : levels) {
+      if (level > regulus::simd::detected_level()) {
+        break;
+      }
+      
+      for (int offset = 0; offset < 8; ++offset) {
+        for (int size = 0; size <= 300; ++size) {
+          T const* first = vec.begin() + offset;
+          T const* last = first + size;
+          T const needle = (T ) (size % 60);
+          
+          assert(
+            regulus::simd::find(first, last, needle, level) ==
+            std::find(first, last, needle));
+          assert(
+            regulus::simd::contains(first, last, needle, level) ==
+            (std::find(first, last, needle) != last));
+          assert(
+            regulus::simd::count(first, last, needle, level) ==
+            (std::size_t ) std::count(first, last, needle));
+          assert(
+            regulus::simd::min_element(first, last, level) ==
+            std::min_element(first, last));
+          assert(
+            regulus::simd::max_element(first, last, level) ==
+            std::max_element(first, last));
+          assert(
+            regulus::simd::accumulate(first, last, T{1}, level) ==
+            std::accumulate(first, last, T{1}));
+        }
+      }
+    }
+  }
+}
+
+namespace regulus
+{
+  template <>
+  struct is_trivially_relocatable<relocatable> : std::true_type {};
+}
 
 int main(void)
 {
@@ -45,7 +166,7 @@ int main(void)
       assert(vec[i] == (i * 2));
     }
   }
-
+  
   // it should support try-catchable element access...
   {
     regulus::static_vector<int, 32> vec;
@@ -71,7 +192,7 @@ int main(void)
     assert(vec.front() == 0);
     assert(vec.back() == 31);
   }
-
+  
   
   // it should support some const stuff
   {
@@ -111,11 +232,11 @@ int main(void)
     assert(*test_it == 1337);
     assert(vec.size() == 17);
   }
-        
+  
   // it should be value constructible
   {
     int const init = 1337;
-    regulus::static_vector<int, 32> vec{init};
+    regulus::static_vector<int, 32> vec(init);
     assert(vec.size() == 32);
     
     for (auto val : vec) {
@@ -127,7 +248,7 @@ int main(void)
   {
     int const init = 1337;
     std::size_t const N = 32;
-    regulus::static_vector<int, N> vec{init};
+    regulus::static_vector<int, N> vec(init);
     
     std::size_t slice_idx = 10;
     
@@ -171,7 +292,7 @@ int main(void)
     
     non_trivial init;
     std::size_t const N = 32;
-    regulus::static_vector<non_trivial, N> vec{init};
+    regulus::static_vector<non_trivial, N> vec(init);
     assert(vec.size() == N);
   }
   
@@ -238,7 +359,7 @@ int main(void)
   // erasing an element at the end should return an
   // end-iterator
   {
-    regulus::static_vector<int, 32> vec{1337};
+    regulus::static_vector<int, 32> vec(1337);
     assert(vec.size() == 32);
     
     typename regulus::static_vector<int, 32>::iterator it = vec.end() - 1;
@@ -250,6 +371,550 @@ int main(void)
     assert(vec.size() == 31);
     assert(diff_it == vec.end());
   }
-        
+  
+  // trivially copyable types should be relocatable by default
+  // and other types should be able to opt in
+  {
+    static_assert(regulus::is_trivially_relocatable<int>::value, "");
+    static_assert(!regulus::is_trivially_relocatable<counted>::value, "");
+    static_assert(regulus::is_trivially_relocatable<relocatable>::value, "");
+  }
+  
+  // inserting at the front of a nearly full vector should shift
+  // every element over by 1
+  {
+    regulus::static_vector<int, 128> vec;
+    for (int i = 0; i < 127; ++i) {
+      vec.emplace_back(i);
+    }
+    
+    auto it = vec.insert(vec.begin(), -1);
+    assert(*it == -1);
+    assert(vec.size() == 128);
+    
+    for (int i = 0; i < 128; ++i) {
+      assert(vec[i] == i - 1);
+    }
+  }
+  
+  // inserting an element of the vector into itself should
+  // still insert the right value
+  {
+    regulus::static_vector<int, 32> vec;
+    for (int i = 0; i < 16; ++i) {
+      vec.emplace_back(i);
+    }
+    
+    vec.insert(vec.begin(), vec[8]);
+    assert(vec[0] == 8);
+    assert(vec[9] == 8);
+  }
+  
+  // shifting non-trivial types should destroy the moved-from
+  // elements
+  {
+    {
+      regulus::static_vector<counted, 32> vec;
+      for (int i = 0; i < 16; ++i) {
+        vec.emplace_back(i);
+      }
+      assert(counted::alive == 16);
+      
+      vec.insert(vec.begin() + 4, counted{1337});
+      assert(counted::alive == 17);
+      assert(vec[4].val == 1337);
+      assert(vec[5].val == 4);
+      
+      auto it = vec.erase(vec.begin() + 4);
+      assert(counted::alive == 16);
+      assert(it->val == 4);
+      
+      for (int i = 0; i < 16; ++i) {
+        assert(vec[i].val == i);
+      }
+      
+      auto chunk = vec.slice(10);
+      assert(counted::alive == 16);
+      assert(vec.size() == 10);
+      assert(chunk.size() == 6);
+      assert(chunk.front().val == 10);
+      assert(chunk.back().val == 15);
+    }
+    assert(counted::alive == 0);
+  }
+  
+  // opted-in types should shift just like trivial ones
+  {
+    regulus::static_vector<relocatable, 32> vec;
+    for (int i = 0; i < 16; ++i) {
+      vec.emplace_back(i);
+    }
+    
+    vec.insert(vec.begin(), relocatable{-1});
+    vec.erase(vec.begin() + 8);
+    
+    auto chunk = vec.slice(8);
+    assert(vec.size() == 8);
+    assert(chunk.size() == 8);
+    
+    for (int i = 0; i < 8; ++i) {
+      assert(vec[i].val == i - 1);
+      assert(chunk[i].val == i + 8);
+    }
+  }
+  
+  // iterators should be plain pointers into contiguous storage
+  {
+    typedef regulus::static_vector<int, 32> vec_t;
+    static_assert(std::is_same<vec_t::iterator, int*>::value, "");
+    static_assert(std::is_same<vec_t::const_iterator, int const*>::value, "");
+    
+    vec_t vec;
+    for (int i = 0; i < 32; ++i) {
+      vec.emplace_back(i);
+    }
+    
+    assert(vec.data() == &vec[0]);
+    assert(vec.end() - vec.begin() == 32);
+    assert(vec.cend() - vec.cbegin() == 32);
+    
+    vec_t const& ref = vec;
+    assert(ref.data() == vec.data());
+    assert(std::accumulate(ref.begin(), ref.end(), 0) == (31 * 32) / 2);
+  }
+  
+  // it should be reverse iterable
+  {
+    regulus::static_vector<int, 32> vec;
+    for (int i = 0; i < 32; ++i) {
+      vec.emplace_back(i);
+    }
+    
+    int i = 31;
+    for (auto it = vec.rbegin(); it != vec.rend(); ++it, --i) {
+      assert(*it == i);
+    }
+    assert(i == -1);
+    
+    assert(std::equal(vec.crbegin(), vec.crend(), vec.rbegin()));
+  }
+  
+  // it should be list-initializable
+  {
+    regulus::static_vector<int, 32> vec{1, 2, 3, 4};
+    assert(vec.size() == 4);
+    for (int i = 0; i < 4; ++i) {
+      assert(vec[i] == i + 1);
+    }
+  }
+  
+  // it should support range insertion in the middle
+  {
+    regulus::static_vector<int, 32> vec{0, 1, 6, 7};
+    int const src[] = {2, 3, 4, 5};
+    
+    auto it = vec.insert(vec.begin() + 2, std::begin(src), std::end(src));
+    assert(it == vec.begin() + 2);
+    assert(vec.size() == 8);
+    for (int i = 0; i < 8; ++i) {
+      assert(vec[i] == i);
+    }
+  }
+  
+  // it should support fill insertion
+  {
+    regulus::static_vector<int, 32> vec{0, 1, 2};
+    
+    auto it = vec.insert(vec.begin() + 1, 3, vec[2]);
+    assert(*it == 2);
+    assert(vec.size() == 6);
+    
+    int const expected[] = {0, 2, 2, 2, 1, 2};
+    assert(std::equal(vec.begin(), vec.end(), std::begin(expected)));
+  }
+  
+  // it should support assign() and append_range()
+  {
+    std::vector<int> batch(64);
+    std::iota(batch.begin(), batch.end(), 0);
+    
+    regulus::static_vector<int, 128> vec{1337, 1337};
+    vec.assign(batch.begin(), batch.end());
+    assert(vec.size() == 64);
+    
+    vec.append_range(batch);
+    assert(vec.size() == 128);
+    
+    for (int i = 0; i < 128; ++i) {
+      assert(vec[i] == i % 64);
+    }
+  }
+  
+  // it should support single-pass ranges
+  {
+    std::istringstream iss{"3 4 5"};
+    regulus::static_vector<int, 32> vec{0, 1, 2, 6};
+    
+    vec.insert(
+      vec.begin() + 3,
+      std::istream_iterator<int>{iss}, std::istream_iterator<int>{});
+    
+    assert(vec.size() == 7);
+    for (int i = 0; i < 7; ++i) {
+      assert(vec[i] == i);
+    }
+  }
+  
+  // range insertion should throw instead of overflowing
+  {
+    regulus::static_vector<int, 4> vec{0, 1, 2};
+    int const src[] = {3, 4};
+    
+    try {
+      vec.insert(vec.end(), std::begin(src), std::end(src));
+      assert(false);
+    } catch (std::length_error& e) {
+      assert(std::strcmp(e.what(), "Capacity exceeded!") == 0);
+    }
+    assert(vec.size() == 3);
+  }
+  
+  // bulk operations should construct and destroy exactly once
+  {
+    {
+      std::vector<counted> src;
+      for (int i = 0; i < 8; ++i) {
+        src.emplace_back(i);
+      }
+      
+      regulus::static_vector<counted, 32> vec;
+      vec.append_range(src);
+      vec.insert(vec.begin(), src.begin(), src.begin() + 4);
+      assert(counted::alive == 20);
+      
+      vec.resize(4);
+      assert(counted::alive == 12);
+      
+      vec.resize(6, counted{-1});
+      assert(counted::alive == 14);
+      assert(vec[5].val == -1);
+      
+      vec.clear();
+      assert(vec.size() == 0);
+      assert(counted::alive == 8);
+    }
+    assert(counted::alive == 0);
+  }
+  
+  // the size should only be as wide as the capacity requires
+  {
+    static_assert(sizeof(regulus::static_vector<std::uint8_t, 16>) == 17, "");
+    static_assert(sizeof(regulus::static_vector<std::uint8_t, 255>) == 256, "");
+    static_assert(sizeof(regulus::static_vector<std::uint8_t, 256>) == 258, "");
+    static_assert(sizeof(regulus::static_vector<int, 32>) == 33 * sizeof(int), "");
+    
+    regulus::static_vector<std::uint8_t, 255> vec;
+    vec.resize(255, 7);
+    assert(vec.size() == 255);
+    assert(vec.back() == 7);
+  }
+  
+  // it should have vectorized kernels that agree with std
+  {
+    check_simd_kernels<std::int32_t>();
+    check_simd_kernels<std::uint32_t>();
+    check_simd_kernels<std::int64_t>();
+    check_simd_kernels<std::uint64_t>();
+    check_simd_kernels<float>();
+    check_simd_kernels<double>();
+    
+    regulus::static_vector<std::uint64_t, 64> vec;
+    for (int i = 0; i < 64; ++i) {
+      vec.emplace_back((std::uint64_t ) (i % 10));
+    }
+    vec[40] = 100;
+    
+    assert(regulus::simd::find(vec, 9) == vec.begin() + 9);
+    assert(regulus::simd::contains(vec, 100));
+    assert(!regulus::simd::contains(vec, 10));
+    assert(regulus::simd::count(vec, 3) == 7);
+    assert(regulus::simd::min_element(vec) == vec.begin());
+    assert(regulus::simd::max_element(vec) == vec.begin() + 40);
+    assert(
+      regulus::simd::accumulate(vec, std::uint64_t{0}) ==
+      std::accumulate(vec.begin(), vec.end(), std::uint64_t{0}));
+    
+    // other types just get the std algorithms
+    regulus::static_vector<std::string, 4> words{"b", "a", "c"};
+    assert(*regulus::simd::min_element(words) == "a");
+    assert(regulus::simd::count(words, "c") == 1);
+    assert(regulus::simd::accumulate(words, std::string{}) == "bac");
+    
+    // the sum is kept in the type of init, so a wider one can't overflow
+    regulus::static_vector<std::int32_t, 64> bigs;
+    bigs.resize(64, std::numeric_limits<std::int32_t>::max());
+    assert(
+      regulus::simd::accumulate(bigs, 0LL) ==
+      64LL * std::numeric_limits<std::int32_t>::max());
+    assert(regulus::simd::accumulate(bigs.begin(), bigs.end(), 0.5) > 1e11);
+    
+    // NaNs don't make min_element run off the end
+    regulus::static_vector<float, 64> floats;
+    floats.resize(64, 1.0f);
+    floats[0] = std::numeric_limits<float>::quiet_NaN();
+    floats[20] = -1.0f;
+    assert(regulus::simd::min_element(floats) != floats.end());
+  }
+  
+  // it should store records column by column
+  {
+    typedef regulus::soa_static_vector<32, std::uint32_t, float, std::uint16_t> vector_type;
+    
+    vector_type vec;
+    for (int i = 0; i < 10; ++i) {
+      vec.emplace_back((std::uint32_t ) i, i * 0.5f, (std::uint16_t ) (i % 3));
+    }
+    vec.push_back(std::make_tuple(100u, 50.0f, (std::uint16_t ) 7));
+    assert(vec.size() == 11);
+    assert(vec.capacity() == 32);
+    
+    // every column is contiguous and starts on a cache line
+    auto scores = vec.column<1>();
+    assert(scores.size() == 11);
+    assert(scores[4] == 2.0f);
+    assert(reinterpret_cast<std::uintptr_t>(scores.data()) % 64 == 0);
+    assert(reinterpret_cast<std::uintptr_t>(vec.column<2>().data()) % 64 == 0);
+    assert(std::accumulate(scores.begin(), scores.end(), 0.0f) == 72.5f);
+    assert(regulus::simd::accumulate(scores.begin(), scores.end(), 0.0f) == 72.5f);
+    
+    for (auto& score : vec.column<1>()) {
+      score *= 2;
+    }
+    assert(vec[3].get<1>() == 3.0f);
+    
+    // proxies read and write whole records
+    std::tuple<std::uint32_t, float, std::uint16_t> record = vec.back();
+    assert(std::get<0>(record) == 100 && std::get<2>(record) == 7);
+    
+    vec[0] = std::make_tuple(42u, -1.0f, (std::uint16_t ) 1);
+    assert(vec.front().get<0>() == 42 && vec.front().get<1>() == -1.0f);
+    vec[1] = vec[0];
+    assert(vec[1].get<0>() == 42);
+    vec[1].get<0>() = 1;
+    assert(vec[0].get<0>() == 42);
+    
+    std::uint32_t ids = 0;
+    for (auto rec : vec) {
+      ids += rec.get<0>();
+    }
+    assert(ids == 42 + 1 + 2 + 3 + 4 + 5 + 6 + 7 + 8 + 9 + 100);
+    
+    vec.erase(vec.begin() + 2);
+    assert(vec.size() == 10);
+    assert(vec[2].get<0>() == 3 && vec[2].get<1>() == 3.0f);
+    
+    std::reverse(vec.begin(), vec.end());
+    assert(vec.front().get<0>() == 100 && vec.back().get<0>() == 42);
+    
+    auto const copy = vec;
+    vector_type::const_iterator it = vec.begin();
+    assert(copy.size() == vec.size());
+    assert(std::get<1>((std::tuple<std::uint32_t, float, std::uint16_t> ) copy[0]) == 100.0f);
+    assert(it == vec.cbegin() && vec.cend() - it == 10);
+    
+    vec.resize(2);
+    assert(vec.size() == 2);
+    vec.resize(4);
+    assert(vec[3].get<0>() == 0 && vec[3].get<1>() == 0.0f);
+    
+    bool thrown = false;
+    try {
+      vec.at(4);
+    } catch (std::out_of_range const&) {
+      thrown = true;
+    }
+    assert(thrown);
+    
+    vec.clear();
+    assert(vec.empty());
+  }
+  
+  // it should construct and destroy every field exactly once
+  {
+    {
+      regulus::soa_static_vector<8, counted, std::string> vec;
+      for (int i = 0; i < 6; ++i) {
+        vec.emplace_back(counted{i}, std::to_string(i));
+      }
+      assert(counted::alive == 6);
+      
+      vec.erase(vec.begin());
+      vec.pop_back();
+      assert(counted::alive == 4);
+      assert(vec[0].get<0>().val == 1 && vec[0].get<1>() == "1");
+      
+      auto moved = std::move(vec);
+      assert(moved.size() == 4);
+      assert(counted::alive == 8);
+      assert(moved.back().get<1>() == "4");
+    }
+    assert(counted::alive == 0);
+  }
+  
+  // it should be emplace-able anywhere
+  {
+    regulus::static_vector<int, 32> vec{0, 1, 3};
+    
+    auto it = vec.emplace(vec.begin() + 2, 2);
+    assert(*it == 2);
+    vec.emplace(vec.end(), 4);
+    vec.emplace(vec.begin(), vec[4]);
+    
+    int const expected[] = {4, 0, 1, 2, 3, 4};
+    assert(vec.size() == 6);
+    assert(std::equal(vec.begin(), vec.end(), std::begin(expected)));
+  }
+  
+  // it should copy, move and swap only the live elements
+  {
+    {
+      regulus::static_vector<counted, 16> a;
+      for (int i = 0; i < 5; ++i) {
+        a.emplace_back(i);
+      }
+      
+      regulus::static_vector<counted, 16> b{a};
+      assert(counted::alive == 10);
+      assert(b.size() == 5 && b[4].val == 4);
+      
+      regulus::static_vector<counted, 16> c{counted{7}, counted{8}};
+      c = a;
+      assert(c.size() == 5 && c[0].val == 0 && c[4].val == 4);
+      b.resize(2);
+      b = a;
+      assert(b.size() == 5 && b[3].val == 3);
+      c.resize(8);
+      c = std::move(b);
+      assert(c.size() == 5 && c[4].val == 4 && b.size() == 0);
+      assert(counted::alive == 10);
+      
+      c = c;
+      assert(c.size() == 5 && c[2].val == 2);
+      
+      c.resize(9);
+      swap(a, c);
+      assert(a.size() == 9 && c.size() == 5);
+      assert(a[4].val == 4 && a[8].val == 0 && c[4].val == 4);
+      assert(counted::alive == 14);
+    }
+    assert(counted::alive == 0);
+    
+    regulus::static_vector<std::string, 8> a{"a", "b", "c"};
+    regulus::static_vector<std::string, 8> b{"long enough to live on the heap"};
+    a.swap(b);
+    assert(a.size() == 1 && a[0] == "long enough to live on the heap");
+    assert(b.size() == 3 && b[2] == "c");
+    
+    auto c = std::move(b);
+    assert(c.size() == 3 && c[0] == "a" && b.size() == 0);
+    b = c;
+    assert(b.size() == 3 && b[1] == "b" && c.size() == 3);
+    
+    regulus::static_vector<std::unique_ptr<int>, 4> p;
+    p.emplace_back(new int{1});
+    p.emplace_back(new int{2});
+    auto q = std::move(p);
+    assert(p.size() == 0 && q.size() == 2 && *q[1] == 2);
+    p.emplace_back(new int{3});
+    q.swap(p);
+    assert(q.size() == 1 && *q[0] == 3 && p.size() == 2 && *p[0] == 1);
+    
+    static_assert(
+      std::is_nothrow_move_constructible<regulus::static_vector<relocatable, 4>>::value,
+      "relocatable elements should move without throwing");
+    
+    // shrinking on assignment shouldn't need a default constructor
+    regulus::static_vector<no_default, 4> big;
+    regulus::static_vector<no_default, 4> small;
+    for (int i = 0; i < 3; ++i) {
+      big.emplace_back(i);
+    }
+    small.emplace_back(7);
+    big = small;
+    assert(big.size() == 1 && big[0].val == 7);
+    small.emplace_back(8);
+    big = small;
+    assert(big.size() == 2 && big[1].val == 8);
+  }
+  
+  // it should move elements off the front of another vector
+  {
+    regulus::static_vector<std::string, 8> a{"a", "b"};
+    regulus::static_vector<std::string, 8> b{"c", "d", "e", "f"};
+    a.splice_front(b, 3);
+    assert(a.size() == 5 && a[2] == "c" && a[4] == "e");
+    assert(b.size() == 1 && b[0] == "f");
+    a.splice_front(b, 1);
+    assert(a.size() == 6 && a.back() == "f" && b.size() == 0);
+  }
+  
+  // it should erase ranges, erase without keeping the order and erase_if
+  {
+    regulus::static_vector<int, 64> vec;
+    for (int i = 0; i < 20; ++i) {
+      vec.emplace_back(i);
+    }
+    
+    auto it = vec.erase(vec.begin() + 2, vec.begin() + 5);
+    assert(*it == 5 && vec.size() == 17);
+    it = vec.erase(vec.begin() + 3, vec.begin() + 3);
+    assert(*it == 6 && vec.size() == 17);
+    it = vec.erase(vec.begin() + 15, vec.end());
+    assert(it == vec.end() && vec.back() == 17);
+    
+    it = vec.erase_unordered(vec.begin());
+    assert(*it == 17 && vec.size() == 14 && vec.back() == 16);
+    it = vec.erase_unordered(vec.end() - 1);
+    assert(it == vec.end() && vec.size() == 13);
+    
+    auto const erased = vec.erase_if([](int const val) { return val % 3 == 0; });
+    int const expected[] = {17, 1, 5, 7, 8, 10, 11, 13, 14};
+    assert(erased == 4 && vec.size() == 9);
+    assert(std::equal(vec.begin(), vec.end(), std::begin(expected)));
+    
+    assert(vec.erase_if([](int) { return false; }) == 0 && vec.size() == 9);
+    assert(vec.erase_if([](int) { return true; }) == 9 && vec.size() == 0);
+    
+    regulus::static_vector<std::string, 16> strs{"a", "bb", "c", "dd", "e"};
+    assert(strs.erase_if([](std::string const& s) { return s.size() == 2; }) == 2);
+    assert(strs.size() == 3 && strs[0] == "a" && strs[1] == "c" && strs[2] == "e");
+    strs.erase_unordered(strs.begin());
+    assert(strs.size() == 2 && strs[0] == "e" && strs[1] == "c");
+    
+    {
+      regulus::static_vector<counted, 16> objs;
+      for (int i = 0; i < 12; ++i) {
+        objs.emplace_back(i);
+      }
+      
+      objs.erase(objs.begin() + 1, objs.begin() + 4);
+      assert(counted::alive == 9 && objs[1].val == 4);
+      objs.erase_unordered(objs.begin() + 1);
+      assert(counted::alive == 8 && objs[1].val == 11);
+      objs.erase_if([](counted const& c) { return c.val % 2 == 1; });
+      assert(counted::alive == 4 && objs.size() == 4);
+      assert(objs[0].val == 0 && objs[1].val == 6 && objs[3].val == 10);
+    }
+    assert(counted::alive == 0);
+    
+    // erasing never needs a default constructor
+    regulus::static_vector<no_default, 8> nds;
+    for (int i = 0; i < 6; ++i) {
+      nds.emplace_back(i);
+    }
+    assert(nds.erase_if([](no_default const& nd) { return nd.val % 2 == 0; }) == 3);
+    assert(nds.size() == 3 && nds[0].val == 1 && nds[2].val == 5);
+  }
+  
   return 0;  
 }
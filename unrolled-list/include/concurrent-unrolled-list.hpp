@@ -0,0 +1,365 @@
+#ifndef REGULUS_CONCURRENT_UNROLLED_LIST_HPP_
+#define REGULUS_CONCURRENT_UNROLLED_LIST_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include "unrolled-list.hpp"
+
+namespace regulus
+{
+  /**
+    * An append-only unrolled list any number of threads can append to
+    * and read from at the same time without taking a lock.
+    *
+    * Producers claim a slot in the tail node by bumping its counter
+    * and construct their element in place. Whoever finds the tail
+    * full installs the next node with a single CAS, everybody else
+    * just helps swing the tail over to it. Every slot gets flagged
+    * once its element is in place, and readers see the published
+    * prefix: everything up to the first slot that's been claimed but
+    * isn't finished yet.
+    *
+    * Nodes are never freed before the list dies so readers don't need
+    * any reclamation scheme. The allocator gets called from whichever
+    * producer fills a node, so it has to be thread-safe (std::allocator
+    * is, pool_allocator isn't).
+    */
+  template <
+    typename T,
+    std::size_t NodeSize = default_node_size<T>::value,
+    typename Allocator = std::allocator<T>
+  >
+  class concurrent_unrolled_list
+  {
+  public:
+    typedef T                 value_type;
+    typedef std::size_t       size_type;
+    typedef std::ptrdiff_t    difference_type;
+    typedef value_type const& const_reference;
+    typedef value_type const* const_pointer;
+    typedef Allocator         allocator_type;
+    
+    std::size_t const static node_size = NodeSize;
+  
+  private:
+    enum slot_state : unsigned char
+    {
+      slot_empty,
+      slot_ready,
+      
+      // the element's constructor threw, readers skip the slot
+      slot_abandoned
+    };
+    
+    struct node
+    {
+    public:
+      std::atomic<node*> next;
+      
+      // slots handed out so far, overshoots node_size once it's full
+      std::atomic<size_type> reserved;
+      
+      std::atomic<unsigned char> state[node_size];
+      std::aligned_storage_t<sizeof(T), alignof(T)> data[node_size];
+    
+    public:
+      node(void)
+        : next{nullptr}
+        , reserved{0}
+      {
+        for (auto& slot : state) {
+          slot.store(slot_empty, std::memory_order_relaxed);
+        }
+      }
+      
+      value_type* address_at(size_type const pos)
+      {
+        return reinterpret_cast<value_type*>(data + pos);
+      }
+      
+      value_type const* address_at(size_type const pos) const
+      {
+        return reinterpret_cast<value_type const*>(data + pos);
+      }
+      
+      unsigned char state_at(size_type const pos) const
+      {
+        return state[pos].load(std::memory_order_acquire);
+      }
+      
+      // slots that have been claimed, whether they're done or not
+      size_type claimed(void) const
+      {
+        auto const count = reserved.load(std::memory_order_acquire);
+        return count < node_size ? count : size_type{node_size};
+      }
+    };
+    
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<node>
+      node_allocator;
+    typedef std::allocator_traits<node_allocator> node_traits;
+  
+  public:
+    class const_iterator :
+      public std::iterator<
+        std::forward_iterator_tag, value_type,
+        difference_type, const_pointer, const_reference>
+    {
+    private:
+      node const* curr_node_;
+      size_type   pos_;
+      
+      // moves forward to the next published element or becomes end()
+      void settle(void)
+      {
+        while (curr_node_ != nullptr) {
+          if (pos_ == node_size) {
+            curr_node_ = curr_node_->next.load(std::memory_order_acquire);
+            pos_ = 0;
+            continue;
+          }
+          
+          auto const state = curr_node_->state_at(pos_);
+          if (state == slot_ready) {
+            return;
+          }
+          if (state == slot_empty) {
+            break;
+          }
+          ++pos_;
+        }
+        
+        curr_node_ = nullptr;
+        pos_ = 0;
+      }
+    
+    public:
+      const_iterator(node const* curr_node, size_type const pos)
+        : curr_node_{curr_node}
+        , pos_{pos}
+      {
+        settle();
+      }
+      
+      const_reference operator*(void) const
+      {
+        return *curr_node_->address_at(pos_);
+      }
+      
+      const_pointer operator->(void) const
+      {
+        return curr_node_->address_at(pos_);
+      }
+      
+      bool operator==(const_iterator const& other) const
+      {
+        return curr_node_ == other.curr_node_ && pos_ == other.pos_;
+      }
+      
+      bool operator!=(const_iterator const& other) const
+      {
+        return !(*this == other);
+      }
+      
+      const_iterator& operator++(void)
+      {
+        ++pos_;
+        settle();
+        return *this;
+      }
+      
+      const_iterator operator++(int)
+      {
+        auto tmp = *this;
+        ++(*this);
+        return tmp;
+      }
+    };
+    
+    typedef const_iterator iterator;
+  
+  private:
+    node_allocator         alloc_;
+    node*                  head_;
+    std::atomic<node*>     tail_;
+    std::atomic<size_type> size_;
+    std::atomic<size_type> node_count_;
+    
+    node* create_node(void)
+    {
+      auto ptr = node_traits::allocate(alloc_, 1);
+      try {
+        node_traits::construct(alloc_, ptr);
+      } catch (...) {
+        node_traits::deallocate(alloc_, ptr, 1);
+        throw;
+      }
+      return ptr;
+    }
+    
+    void destroy_node(node* ptr)
+    {
+      node_traits::destroy(alloc_, ptr);
+      node_traits::deallocate(alloc_, ptr, 1);
+    }
+    
+    // curr ran out of slots, make sure it has a successor and that
+    // the tail moved on to it
+    void advance_tail(node* curr)
+    {
+      auto next = curr->next.load(std::memory_order_acquire);
+      if (next == nullptr) {
+        auto fresh = create_node();
+        if (curr->next.compare_exchange_strong(
+              next, fresh,
+              std::memory_order_acq_rel, std::memory_order_acquire)) {
+          next = fresh;
+          node_count_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+          // somebody beat us to it and next holds their node now
+          destroy_node(fresh);
+        }
+      }
+      
+      tail_.compare_exchange_strong(
+        curr, next,
+        std::memory_order_acq_rel, std::memory_order_relaxed);
+    }
+  
+  public:
+    concurrent_unrolled_list(void)
+      : concurrent_unrolled_list(Allocator{})
+    {}
+    
+    explicit concurrent_unrolled_list(Allocator const& alloc)
+      : alloc_{alloc}
+      , head_{create_node()}
+      , tail_{head_}
+      , size_{0}
+      , node_count_{1}
+    {}
+    
+    concurrent_unrolled_list(concurrent_unrolled_list const&) = delete;
+    concurrent_unrolled_list& operator=(concurrent_unrolled_list const&) = delete;
+    
+    // nobody may be appending or reading anymore by now
+    ~concurrent_unrolled_list(void)
+    {
+      while (head_ != nullptr) {
+        auto tmp = head_;
+        head_ = head_->next.load(std::memory_order_relaxed);
+        
+        auto const claimed = tmp->claimed();
+        for (size_type pos = 0; pos < claimed; ++pos) {
+          if (tmp->state_at(pos) == slot_ready) {
+            tmp->address_at(pos)->~value_type();
+          }
+        }
+        destroy_node(tmp);
+      }
+    }
+    
+    // Iterators, they only ever see the published prefix
+    const_iterator begin(void) const
+    {
+      return const_iterator{head_, 0};
+    }
+    
+    const_iterator end(void) const
+    {
+      return const_iterator{nullptr, 0};
+    }
+    
+    /**
+      * Calls f(first, last) with the pointer ranges that make up the
+      * published prefix, which is one range per node unless a slot
+      * was abandoned.
+      */
+    template <typename F>
+    void for_each_segment(F f) const
+    {
+      for (node const* curr = head_; curr != nullptr;
+           curr = curr->next.load(std::memory_order_acquire)) {
+        auto const claimed = curr->claimed();
+        size_type first = 0;
+        for (size_type pos = 0; pos < claimed; ++pos) {
+          auto const state = curr->state_at(pos);
+          if (state == slot_ready) {
+            continue;
+          }
+          
+          if (first < pos) {
+            f(curr->address_at(first), curr->address_at(pos));
+          }
+          if (state == slot_empty) {
+            return;
+          }
+          first = pos + 1;
+        }
+        
+        if (first < claimed) {
+          f(curr->address_at(first), curr->address_at(claimed));
+        }
+        if (claimed < node_size) {
+          return;
+        }
+      }
+    }
+    
+    // Capacity, both lag behind appends that are still in flight
+    size_type size(void) const
+    {
+      return size_.load(std::memory_order_acquire);
+    }
+    
+    bool empty(void) const
+    {
+      return size() == 0;
+    }
+    
+    size_type node_count(void) const
+    {
+      return node_count_.load(std::memory_order_relaxed);
+    }
+    
+    // Modifiers, safe to call from any number of threads
+    template <typename ...Args>
+    void emplace_back(Args&& ...args)
+    {
+      while (true) {
+        auto curr = tail_.load(std::memory_order_acquire);
+        
+        // don't bother bumping a counter that's already run over
+        if (curr->reserved.load(std::memory_order_relaxed) < node_size) {
+          auto const pos = curr->reserved.fetch_add(1, std::memory_order_relaxed);
+          if (pos < node_size) {
+            try {
+              new(curr->address_at(pos)) value_type(std::forward<Args>(args)...);
+            } catch (...) {
+              curr->state[pos].store(slot_abandoned, std::memory_order_release);
+              throw;
+            }
+            
+            curr->state[pos].store(slot_ready, std::memory_order_release);
+            size_.fetch_add(1, std::memory_order_release);
+            return;
+          }
+        }
+        
+        advance_tail(curr);
+      }
+    }
+    
+    void push_back(const_reference val)
+    {
+      emplace_back(val);
+    }
+  };
+}
+
+#endif // REGULUS_CONCURRENT_UNROLLED_LIST_HPP_
@@ -0,0 +1,154 @@
+#ifndef REGULUS_FENWICK_TREE_HPP_
+#define REGULUS_FENWICK_TREE_HPP_
+
+#include <cstddef>
+#include <vector>
+
+namespace regulus
+{
+  namespace detail
+  {
+    /**
+      * A Fenwick (binary indexed) tree over a sequence of counts.
+      * Point updates and prefix sums are O(log n) and so is finding
+      * which entry a running total falls into. Entries can be pushed
+      * and popped at the back without rebuilding anything, inserting
+      * or removing one further in rebuilds only the entries after it.
+      */
+    class fenwick_tree
+    {
+    public:
+      typedef std::size_t size_type;
+    
+    private:
+      // 1-based, tree_[0] is unused
+      std::vector<size_type> tree_;
+      
+      static size_type lowbit(size_type const i)
+      {
+        return i & (~i + 1);
+      }
+    
+    public:
+      fenwick_tree(void)
+        : tree_(1, 0)
+      {}
+      
+      size_type size(void) const
+      {
+        return tree_.size() - 1;
+      }
+      
+      void clear(void)
+      {
+        tree_.assign(1, 0);
+      }
+      
+      // builds the tree out of count_at(0), ..., count_at(n - 1) in O(n),
+      // calling count_at exactly once per entry and in that order
+      template <typename F>
+      void assign(size_type const n, F count_at)
+      {
+        tree_.resize(n + 1);
+        tree_[0] = 0;
+        for (size_type i = 0; i < n; ++i) {
+          tree_[i + 1] = count_at(i);
+        }
+        
+        for (size_type i = 1; i <= n; ++i) {
+          auto const parent = i + lowbit(i);
+          if (parent <= n) {
+            tree_[parent] += tree_[i];
+          }
+        }
+      }
+      
+      /**
+        * Keeps the first pos entries and rebuilds the rest out of
+        * count_at(pos), ..., count_at(n - 1), calling it once per entry
+        * and in that order. O(n - pos + log^2 n), so cheap towards the
+        * back and no better than assign() at the front.
+        */
+      template <typename F>
+      void assign_from(size_type const pos, size_type const n, F count_at)
+      {
+        tree_.resize(n + 1);
+        for (auto i = pos; i < n; ++i) {
+          tree_[i + 1] = count_at(i);
+        }
+        
+        // the usual bottom up build, but only out of the new entries
+        for (auto i = pos + 1; i <= n; ++i) {
+          auto const parent = i + lowbit(i);
+          if (parent <= n) {
+            tree_[parent] += tree_[i];
+          }
+        }
+        
+        // tree nodes whose range starts before pos are still missing
+        // the kept entries in it, the untouched front can sum those up
+        if (pos > 0) {
+          auto const kept = prefix(pos);
+          for (auto i = pos + lowbit(pos); i <= n; i += lowbit(i)) {
+            tree_[i] += kept - prefix(i - lowbit(i));
+          }
+        }
+      }
+      
+      // sum of the first count entries
+      size_type prefix(size_type count) const
+      {
+        size_type sum = 0;
+        for (; count > 0; count -= lowbit(count)) {
+          sum += tree_[count];
+        }
+        return sum;
+      }
+      
+      void add(size_type const pos, std::ptrdiff_t const delta)
+      {
+        for (auto i = pos + 1; i < tree_.size(); i += lowbit(i)) {
+          tree_[i] += delta;
+        }
+      }
+      
+      void push_back(size_type const count)
+      {
+        auto const i = tree_.size();
+        tree_.push_back(count + prefix(i - 1) - prefix(i - lowbit(i)));
+      }
+      
+      void pop_back(void)
+      {
+        tree_.pop_back();
+      }
+      
+      /**
+        * Find the entry that the running total `target` lands in, i.e.
+        * the largest pos with prefix(pos) <= target. The offset of target
+        * into that entry is written to offset.
+        */
+      size_type find(size_type target, size_type& offset) const
+      {
+        size_type pos = 0;
+        size_type step = 1;
+        while (step * 2 <= size()) {
+          step *= 2;
+        }
+        
+        for (; step > 0; step /= 2) {
+          auto const next = pos + step;
+          if (next <= size() && tree_[next] <= target) {
+            pos = next;
+            target -= tree_[next];
+          }
+        }
+        
+        offset = target;
+        return pos;
+      }
+    };
+  }
+}
+
+#endif // REGULUS_FENWICK_TREE_HPP_
@@ -0,0 +1,388 @@
+#ifndef REGULUS_PARALLEL_HPP_
+#define REGULUS_PARALLEL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "unrolled-list.hpp"
+
+namespace regulus
+{
+  /**
+    * A small work-stealing thread pool. Every worker owns a queue,
+    * works through it front to back and steals from the back of the
+    * other queues once its own runs dry. Threads waiting on a batch
+    * of tasks (see run_batch()) help out instead of blocking.
+    */
+  class thread_pool
+  {
+  public:
+    typedef std::function<void(void)> task;
+  
+  private:
+    struct worker_queue
+    {
+      std::mutex       mutex;
+      std::deque<task> tasks;
+    };
+    
+    std::vector<std::unique_ptr<worker_queue>> queues_;
+    std::vector<std::thread>                   threads_;
+    
+    std::mutex              wake_mutex_;
+    std::condition_variable wake_;
+    std::atomic<std::size_t> queued_;
+    bool                    stop_;
+    
+    bool pop_front(std::size_t const idx, task& out)
+    {
+      auto& queue = *queues_[idx];
+      std::lock_guard<std::mutex> lock{queue.mutex};
+      if (queue.tasks.empty()) {
+        return false;
+      }
+      out = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      --queued_;
+      return true;
+    }
+    
+    bool steal(std::size_t const idx, task& out)
+    {
+      auto& queue = *queues_[idx];
+      std::lock_guard<std::mutex> lock{queue.mutex};
+      if (queue.tasks.empty()) {
+        return false;
+      }
+      out = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      --queued_;
+      return true;
+    }
+    
+    // own queue first, then everybody else's starting with our neighbour
+    bool try_pop(std::size_t const self, task& out)
+    {
+      if (self < queues_.size() && pop_front(self, out)) {
+        return true;
+      }
+      
+      auto const n = queues_.size();
+      for (std::size_t i = 1; i <= n; ++i) {
+        auto const victim = (self + i) % n;
+        if (victim != self && steal(victim, out)) {
+          return true;
+        }
+      }
+      return false;
+    }
+    
+    void work(std::size_t const self)
+    {
+      task t;
+      while (true) {
+        if (try_pop(self, t)) {
+          t();
+          continue;
+        }
+        
+        std::unique_lock<std::mutex> lock{wake_mutex_};
+        wake_.wait(lock, [this]
+        {
+          return stop_ || queued_.load() > 0;
+        });
+        
+        if (stop_ && queued_.load() == 0) {
+          return;
+        }
+      }
+    }
+  
+  public:
+    explicit thread_pool(
+      std::size_t const num_threads = std::thread::hardware_concurrency())
+      : queued_{0}
+      , stop_{false}
+    {
+      auto const n = num_threads > 0 ? num_threads : 1;
+      for (std::size_t i = 0; i < n; ++i) {
+        queues_.emplace_back(new worker_queue);
+      }
+      for (std::size_t i = 0; i < n; ++i) {
+        threads_.emplace_back([this, i]
+        {
+          work(i);
+        });
+      }
+    }
+    
+    thread_pool(thread_pool const&) = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+    
+    ~thread_pool(void)
+    {
+      {
+        std::lock_guard<std::mutex> lock{wake_mutex_};
+        stop_ = true;
+      }
+      wake_.notify_all();
+      
+      for (auto& thread : threads_) {
+        thread.join();
+      }
+    }
+    
+    // the pool the parallel algorithms use unless they're given one
+    static thread_pool& default_pool(void)
+    {
+      static thread_pool pool;
+      return pool;
+    }
+    
+    std::size_t size(void) const
+    {
+      return threads_.size();
+    }
+    
+    // queues t on the worker picked by hint
+    void submit(task t, std::size_t const hint = 0)
+    {
+      // counted under the queue's lock, so nobody can pop it before it's
+      // counted and a woken worker always finds something to pop
+      {
+        auto& queue = *queues_[hint % queues_.size()];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        queue.tasks.push_back(std::move(t));
+        ++queued_;
+      }
+      
+      // a worker that just saw queued_ == 0 holds wake_mutex_ until it's
+      // waiting, so this can't slip in before it goes to sleep
+      std::lock_guard<std::mutex> lock{wake_mutex_};
+      wake_.notify_one();
+    }
+    
+    /**
+      * Runs tasks and returns once all of them are done, spreading
+      * them over the workers round robin. The calling thread helps
+      * out by stealing until the batch is finished. The first
+      * exception thrown by a task gets rethrown here.
+      */
+    void run_batch(std::vector<task>& tasks)
+    {
+      std::atomic<std::size_t> remaining{tasks.size()};
+      std::exception_ptr       error;
+      std::mutex               error_mutex;
+      
+      for (std::size_t i = 0; i < tasks.size(); ++i) {
+        auto& t = tasks[i];
+        submit([&t, &remaining, &error, &error_mutex]
+        {
+          try {
+            t();
+          } catch (...) {
+            std::lock_guard<std::mutex> lock{error_mutex};
+            if (!error) {
+              error = std::current_exception();
+            }
+          }
+          --remaining;
+        }, i);
+      }
+      
+      task t;
+      while (remaining.load() > 0) {
+        if (try_pop(queues_.size(), t)) {
+          t();
+        } else {
+          std::this_thread::yield();
+        }
+      }
+      
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+  };
+  
+  namespace detail
+  {
+    /**
+      * Cuts the node chain of a list into ranges of whole nodes holding
+      * roughly the same number of elements each. Nodes are the grain so
+      * no element range ever straddles two tasks' worth of bookkeeping.
+      */
+    template <typename SegmentIt>
+    std::vector<std::pair<SegmentIt, SegmentIt>> partition_segments(
+      SegmentIt first, SegmentIt last,
+      std::size_t const total, std::size_t const parts)
+    {
+      std::vector<std::pair<SegmentIt, SegmentIt>> ranges;
+      auto const target = (total + parts - 1) / parts;
+      
+      auto range_begin = first;
+      std::size_t count = 0;
+      for (; first != last; ++first) {
+        count += (*first).size();
+        if (count >= target) {
+          auto next = first;
+          ++next;
+          ranges.emplace_back(range_begin, next);
+          range_begin = next;
+          count = 0;
+        }
+      }
+      
+      if (count > 0) {
+        ranges.emplace_back(range_begin, last);
+      }
+      return ranges;
+    }
+    
+    // below this we don't bother waking anybody up
+    std::size_t const parallel_cutoff = 16 * 1024;
+    
+    // a few chunks per worker leaves something to steal
+    std::size_t const chunks_per_worker = 4;
+    
+    template <typename List, typename F>
+    void parallel_segments(List& list, thread_pool& pool, F f)
+    {
+      auto segs = list.segments();
+      if (list.size() < parallel_cutoff || pool.size() < 2) {
+        f(segs.begin(), segs.end());
+        return;
+      }
+      
+      auto ranges = partition_segments(
+        segs.begin(), segs.end(),
+        list.size(), pool.size() * chunks_per_worker);
+      
+      std::vector<thread_pool::task> tasks;
+      tasks.reserve(ranges.size());
+      for (auto const& range : ranges) {
+        tasks.emplace_back([range, &f]
+        {
+          f(range.first, range.second);
+        });
+      }
+      
+      pool.run_batch(tasks);
+    }
+  }
+  
+  /**
+    * Calls f on every element of the list using the pool's threads.
+    * f has to be safe to call concurrently and the order of the calls
+    * is unspecified.
+    */
+  template <typename T, std::size_t N, typename ...Options, typename F>
+  void parallel_for_each(
+    unrolled_list<T, N, Options...>& list, F f,
+    thread_pool& pool = thread_pool::default_pool())
+  {
+    detail::parallel_segments(list, pool, [&f](auto first, auto last)
+    {
+      for (; first != last; ++first) {
+        auto seg = *first;
+        for (auto ptr = seg.begin(), end = seg.end(); ptr != end; ++ptr) {
+          f(*ptr);
+        }
+        seg.summarize();
+      }
+    });
+  }
+  
+  // replaces every element x with op(x)
+  template <typename T, std::size_t N, typename ...Options, typename UnaryOp>
+  void parallel_transform_inplace(
+    unrolled_list<T, N, Options...>& list, UnaryOp op,
+    thread_pool& pool = thread_pool::default_pool())
+  {
+    detail::parallel_segments(list, pool, [&op](auto first, auto last)
+    {
+      for (; first != last; ++first) {
+        auto seg = *first;
+        for (auto ptr = seg.begin(), end = seg.end(); ptr != end; ++ptr) {
+          *ptr = op(*ptr);
+        }
+        seg.summarize();
+      }
+    });
+  }
+  
+  /**
+    * Folds the list with op like std::reduce does. Every chunk gets
+    * reduced on its own starting from a copy of init, then the partial
+    * results are folded together. So op has to be associative and
+    * commutative, callable as op(U, T) as well as op(U, U), and init
+    * has to be an identity for it (0 for +, 1 for *).
+    */
+  template <
+    typename T, std::size_t N, typename ...Options,
+    typename U, typename BinaryOp
+  >
+  U parallel_reduce(
+    unrolled_list<T, N, Options...> const& list, U init, BinaryOp op,
+    thread_pool& pool = thread_pool::default_pool())
+  {
+    auto segs = list.segments();
+    if (list.size() < detail::parallel_cutoff || pool.size() < 2) {
+      for (auto seg : segs) {
+        for (auto ptr = seg.begin(), end = seg.end(); ptr != end; ++ptr) {
+          init = op(std::move(init), *ptr);
+        }
+      }
+      return init;
+    }
+    
+    auto ranges = detail::partition_segments(
+      segs.begin(), segs.end(),
+      list.size(), pool.size() * detail::chunks_per_worker);
+    
+    // each task folds into a local and only stores it once at the end,
+    // so the workers don't keep writing to the same cache lines
+    std::vector<U> partials(ranges.size(), init);
+    std::vector<thread_pool::task> tasks;
+    tasks.reserve(ranges.size());
+    
+    for (std::size_t i = 0; i < ranges.size(); ++i) {
+      tasks.emplace_back([&ranges, &partials, &op, &init, i]
+      {
+        U partial = init;
+        for (auto it = ranges[i].first; it != ranges[i].second; ++it) {
+          auto seg = *it;
+          for (auto ptr = seg.begin(), end = seg.end(); ptr != end; ++ptr) {
+            partial = op(std::move(partial), *ptr);
+          }
+        }
+        partials[i] = std::move(partial);
+      });
+    }
+    
+    pool.run_batch(tasks);
+    
+    auto result = std::move(partials.front());
+    for (std::size_t i = 1; i < partials.size(); ++i) {
+      result = op(std::move(result), std::move(partials[i]));
+    }
+    return result;
+  }
+  
+  template <typename T, std::size_t N, typename ...Options>
+  T parallel_reduce(
+    unrolled_list<T, N, Options...> const& list,
+    thread_pool& pool = thread_pool::default_pool())
+  {
+    return parallel_reduce(list, T{}, std::plus<T>{}, pool);
+  }
+}
+
+#endif // REGULUS_PARALLEL_HPP_
@@ -0,0 +1,226 @@
+#ifndef REGULUS_POOL_ALLOCATOR_HPP_
+#define REGULUS_POOL_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+#include <algorithm>
+
+namespace regulus
+{
+  namespace detail
+  {
+    std::size_t const cache_line_size = 64;
+    
+    /**
+      * Hands out fixed-size slots carved from big contiguous blocks.
+      * Freed slots go onto an intrusive free list and get reused
+      * before we carve anything new. Blocks are only given back to
+      * the system when the pool itself dies.
+      */
+    class slot_pool
+    {
+    private:
+      struct free_slot
+      {
+        free_slot* next;
+      };
+      
+      std::size_t       size_;
+      std::size_t       align_;
+      std::size_t       slot_size_;
+      std::size_t       slot_align_;
+      std::size_t       slots_per_block_;
+      std::vector<void*> blocks_;
+      free_slot*        free_list_;
+      char*             cursor_;
+      char*             block_end_;
+      
+      void add_block(void)
+      {
+        auto const bytes = slot_size_ * slots_per_block_ + slot_align_;
+        void* block = ::operator new(bytes);
+        blocks_.push_back(block);
+        
+        auto space = bytes;
+        void* aligned = block;
+        std::align(slot_align_, slot_size_ * slots_per_block_, aligned, space);
+        
+        cursor_ = static_cast<char*>(aligned);
+        block_end_ = cursor_ + slot_size_ * slots_per_block_;
+      }
+    
+    public:
+      slot_pool(
+        std::size_t const size, std::size_t const align,
+        std::size_t const block_size)
+        : size_{size}
+        , align_{align}
+        , slot_size_{0}
+        , slot_align_{std::max(align, alignof(free_slot))}
+        , slots_per_block_{0}
+        , free_list_{nullptr}
+        , cursor_{nullptr}
+        , block_end_{nullptr}
+      {
+        // every slot has to be able to hold a free list link and
+        // keep the next slot aligned
+        // anything a cache line or bigger starts on a line of its own
+        // so whatever sits at its front never straddles two of them
+        if (size >= cache_line_size) {
+          slot_align_ = std::max(slot_align_, cache_line_size);
+        }
+        
+        slot_size_ = std::max(size, sizeof(free_slot));
+        slot_size_ = (slot_size_ + slot_align_ - 1) / slot_align_ * slot_align_;
+        slots_per_block_ = std::max<std::size_t>(1, block_size / slot_size_);
+      }
+      
+      slot_pool(slot_pool const&) = delete;
+      slot_pool& operator=(slot_pool const&) = delete;
+      
+      ~slot_pool(void)
+      {
+        for (auto block : blocks_) {
+          ::operator delete(block);
+        }
+      }
+      
+      bool serves(std::size_t const size, std::size_t const align) const
+      {
+        return size_ == size && align_ == align;
+      }
+      
+      void* allocate(void)
+      {
+        if (free_list_ != nullptr) {
+          auto slot = free_list_;
+          free_list_ = slot->next;
+          return slot;
+        }
+        
+        if (cursor_ == block_end_) {
+          add_block();
+        }
+        
+        auto slot = cursor_;
+        cursor_ += slot_size_;
+        return slot;
+      }
+      
+      void deallocate(void* ptr)
+      {
+        auto slot = static_cast<free_slot*>(ptr);
+        slot->next = free_list_;
+        free_list_ = slot;
+      }
+    };
+    
+    // one slot_pool per distinct object size, shared by every copy
+    // (and rebound copy) of a pool_allocator
+    class pool_arena
+    {
+    private:
+      std::size_t                             block_size_;
+      std::vector<std::unique_ptr<slot_pool>> pools_;
+    
+    public:
+      explicit pool_arena(std::size_t const block_size)
+        : block_size_{block_size}
+      {}
+      
+      slot_pool& pool_for(std::size_t const size, std::size_t const align)
+      {
+        for (auto& pool : pools_) {
+          if (pool->serves(size, align)) {
+            return *pool;
+          }
+        }
+        
+        pools_.push_back(
+          std::unique_ptr<slot_pool>{new slot_pool{size, align, block_size_}});
+        return *pools_.back();
+      }
+    };
+  }
+  
+  /**
+    * A std-compatible allocator that serves single objects out of a
+    * shared slab of contiguous blocks and recycles freed objects
+    * through a free list. Anything other than a single object goes
+    * straight to operator new.
+    *
+    * Copies and rebound copies share the same arena, which lives as
+    * long as any of them does.
+    */
+  template <typename T>
+  class pool_allocator
+  {
+  private:
+    template <typename U>
+    friend class pool_allocator;
+    
+    std::shared_ptr<detail::pool_arena> arena_;
+    detail::slot_pool*                  pool_;
+  
+  public:
+    typedef T              value_type;
+    typedef std::size_t    size_type;
+    typedef std::ptrdiff_t difference_type;
+    
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+    
+    template <typename U>
+    struct rebind
+    {
+      typedef pool_allocator<U> other;
+    };
+    
+    static std::size_t const default_block_size = 64 * 1024;
+    
+    explicit pool_allocator(std::size_t const block_size = default_block_size)
+      : arena_{std::make_shared<detail::pool_arena>(block_size)}
+      , pool_{std::addressof(arena_->pool_for(sizeof(T), alignof(T)))}
+    {}
+    
+    template <typename U>
+    pool_allocator(pool_allocator<U> const& other)
+      : arena_{other.arena_}
+      , pool_{std::addressof(arena_->pool_for(sizeof(T), alignof(T)))}
+    {}
+    
+    T* allocate(std::size_t const count)
+    {
+      if (count == 1) {
+        return static_cast<T*>(pool_->allocate());
+      }
+      return static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+    
+    void deallocate(T* ptr, std::size_t const count)
+    {
+      if (count == 1) {
+        pool_->deallocate(ptr);
+        return;
+      }
+      ::operator delete(ptr);
+    }
+    
+    template <typename U>
+    bool operator==(pool_allocator<U> const& other) const
+    {
+      return arena_ == other.arena_;
+    }
+    
+    template <typename U>
+    bool operator!=(pool_allocator<U> const& other) const
+    {
+      return !(*this == other);
+    }
+  };
+}
+
+#endif // REGULUS_POOL_ALLOCATOR_HPP_
@@ -0,0 +1,208 @@
+#ifndef REGULUS_SEGMENTED_ALGORITHM_HPP_
+#define REGULUS_SEGMENTED_ALGORITHM_HPP_
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+#include "simd-algorithm.hpp"
+#include "unrolled-list.hpp"
+
+/**
+  * Algorithm overloads for unrolled_list that run segment by segment.
+  * The inner loop of each one is a plain loop over a node's pointer
+  * range so compilers can vectorize it, and the node hop only happens
+  * once per segment instead of being a branch on every element.
+  */
+namespace regulus
+{
+  // f may modify the elements, node summaries are rebuilt afterwards
+  template <typename T, std::size_t N, typename ...Options, typename F>
+  F for_each(unrolled_list<T, N, Options...>& list, F f)
+  {
+    for (auto seg : list.segments()) {
+      for (auto ptr = seg.begin(), end = seg.end(); ptr != end; ++ptr) {
+        f(*ptr);
+      }
+      seg.summarize();
+    }
+    return f;
+  }
+  
+  template <typename T, std::size_t N, typename ...Options, typename F>
+  F for_each(unrolled_list<T, N, Options...> const& list, F f)
+  {
+    for (auto seg : list.segments()) {
+      for (auto ptr = seg.begin(), end = seg.end(); ptr != end; ++ptr) {
+        f(*ptr);
+      }
+    }
+    return f;
+  }
+  
+  template <
+    typename T, std::size_t N, typename ...Options,
+    typename OutputIt, typename UnaryOp
+  >
+  OutputIt transform(
+    unrolled_list<T, N, Options...> const& list, OutputIt d_first, UnaryOp op)
+  {
+    for (auto seg : list.segments()) {
+      d_first = std::transform(seg.begin(), seg.end(), d_first, op);
+    }
+    return d_first;
+  }
+  
+  template <typename T, std::size_t N, typename ...Options, typename U>
+  U accumulate(unrolled_list<T, N, Options...> const& list, U init)
+  {
+    for (auto seg : list.segments()) {
+      init = std::accumulate(seg.begin(), seg.end(), std::move(init));
+    }
+    return init;
+  }
+  
+  template <
+    typename T, std::size_t N, typename ...Options,
+    typename U, typename BinaryOp
+  >
+  U accumulate(unrolled_list<T, N, Options...> const& list, U init, BinaryOp op)
+  {
+    for (auto seg : list.segments()) {
+      init = std::accumulate(seg.begin(), seg.end(), std::move(init), op);
+    }
+    return init;
+  }
+  
+  template <typename T, std::size_t N, typename ...Options, typename U>
+  typename unrolled_list<T, N, Options...>::iterator
+  find(unrolled_list<T, N, Options...> const& list, U const& value)
+  {
+    for (auto seg : list.segments()) {
+      auto const it = std::find(seg.begin(), seg.end(), value);
+      if (it != seg.end()) {
+        return list.to_iterator(seg, it);
+      }
+    }
+    return list.end();
+  }
+  
+  template <typename T, std::size_t N, typename ...Options, typename Pred>
+  typename unrolled_list<T, N, Options...>::iterator
+  find_if(unrolled_list<T, N, Options...> const& list, Pred pred)
+  {
+    for (auto seg : list.segments()) {
+      auto const it = std::find_if(seg.begin(), seg.end(), pred);
+      if (it != seg.end()) {
+        return list.to_iterator(seg, it);
+      }
+    }
+    return list.end();
+  }
+  
+  template <typename T, std::size_t N, typename ...Options, typename U>
+  std::size_t count(unrolled_list<T, N, Options...> const& list, U const& value)
+  {
+    std::size_t total = 0;
+    for (auto seg : list.segments()) {
+      total += std::count(seg.begin(), seg.end(), value);
+    }
+    return total;
+  }
+  
+  template <typename T, std::size_t N, typename ...Options, typename Pred>
+  std::size_t count_if(unrolled_list<T, N, Options...> const& list, Pred pred)
+  {
+    std::size_t total = 0;
+    for (auto seg : list.segments()) {
+      total += std::count_if(seg.begin(), seg.end(), pred);
+    }
+    return total;
+  }
+  
+  /**
+    * The vectorized kernels from simd-algorithm.hpp run over one
+    * segment at a time. The level is looked up once per call.
+    */
+  namespace simd
+  {
+    template <typename T, std::size_t N, typename ...Options>
+    typename unrolled_list<T, N, Options...>::iterator
+    find(unrolled_list<T, N, Options...> const& list, detail::identity_t<T> const& val)
+    {
+      auto const level = detected_level();
+      for (auto seg : list.segments()) {
+        auto const it = simd::find(seg.begin(), seg.end(), val, level);
+        if (it != seg.end()) {
+          return list.to_iterator(seg, it);
+        }
+      }
+      return list.end();
+    }
+    
+    template <typename T, std::size_t N, typename ...Options>
+    bool contains(
+      unrolled_list<T, N, Options...> const& list, detail::identity_t<T> const& val)
+    {
+      return simd::find(list, val) != list.end();
+    }
+    
+    template <typename T, std::size_t N, typename ...Options>
+    std::size_t count(
+      unrolled_list<T, N, Options...> const& list, detail::identity_t<T> const& val)
+    {
+      auto const level = detected_level();
+      std::size_t total = 0;
+      for (auto seg : list.segments()) {
+        total += simd::count(seg.begin(), seg.end(), val, level);
+      }
+      return total;
+    }
+    
+    template <typename T, std::size_t N, typename ...Options>
+    typename unrolled_list<T, N, Options...>::iterator
+    min_element(unrolled_list<T, N, Options...> const& list)
+    {
+      auto const level = detected_level();
+      auto best = list.end();
+      T const* best_ptr = nullptr;
+      for (auto seg : list.segments()) {
+        auto const it = simd::min_element(seg.begin(), seg.end(), level);
+        if (it != seg.end() && (best_ptr == nullptr || *it < *best_ptr)) {
+          best = list.to_iterator(seg, it);
+          best_ptr = it;
+        }
+      }
+      return best;
+    }
+    
+    template <typename T, std::size_t N, typename ...Options>
+    typename unrolled_list<T, N, Options...>::iterator
+    max_element(unrolled_list<T, N, Options...> const& list)
+    {
+      auto const level = detected_level();
+      auto best = list.end();
+      T const* best_ptr = nullptr;
+      for (auto seg : list.segments()) {
+        auto const it = simd::max_element(seg.begin(), seg.end(), level);
+        if (it != seg.end() && (best_ptr == nullptr || *best_ptr < *it)) {
+          best = list.to_iterator(seg, it);
+          best_ptr = it;
+        }
+      }
+      return best;
+    }
+    
+    template <typename T, std::size_t N, typename ...Options, typename U>
+    U accumulate(unrolled_list<T, N, Options...> const& list, U init)
+    {
+      auto const level = detected_level();
+      for (auto seg : list.segments()) {
+        init = simd::accumulate(seg.begin(), seg.end(), std::move(init), level);
+      }
+      return init;
+    }
+  }
+}
+
+#endif // REGULUS_SEGMENTED_ALGORITHM_HPP_
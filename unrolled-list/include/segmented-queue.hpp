@@ -0,0 +1,282 @@
+#ifndef REGULUS_SEGMENTED_QUEUE_HPP_
+#define REGULUS_SEGMENTED_QUEUE_HPP_
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "unrolled-list.hpp"
+
+namespace regulus
+{
+  /**
+    * A FIFO queue on a chain of unrolled_list style nodes. Elements go
+    * in at the tail node's end and come out at the head node's front,
+    * so neither end ever shifts anything. Drained nodes go onto a free
+    * list and get reused as new tails, which means a queue that's
+    * stopped growing doesn't allocate anymore.
+    */
+  template <
+    typename T,
+    std::size_t NodeSize = default_node_size<T>::value,
+    typename Allocator = std::allocator<T>
+  >
+  class segmented_queue
+  {
+  public:
+    typedef T                 value_type;
+    typedef std::size_t       size_type;
+    typedef value_type&       reference;
+    typedef value_type const& const_reference;
+    typedef Allocator         allocator_type;
+    
+    std::size_t const static node_size = NodeSize;
+  
+  private:
+    struct node
+    {
+    public:
+      node* next;
+      std::aligned_storage_t<sizeof(T), alignof(T)> data[node_size];
+    
+    public:
+      node(void)
+        : next{nullptr}
+      {}
+      
+      value_type* begin(void)
+      {
+        return reinterpret_cast<value_type*>(data);
+      }
+      
+      value_type* end(void)
+      {
+        return reinterpret_cast<value_type*>(data + node_size);
+      }
+    };
+    
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<node>
+      node_allocator;
+    typedef std::allocator_traits<node_allocator> node_traits;
+    
+    node_allocator alloc_;
+    node* head_;
+    node* tail_;
+    
+    // like std::deque we keep raw cursors into the end nodes so
+    // pushing and popping don't have to go through the node headers:
+    // the head node's elements start at front_, the tail's end at back_
+    value_type* front_;
+    value_type* back_;
+    size_type size_;
+    
+    // drained nodes waiting to become a tail again
+    node* free_;
+    size_type free_count_;
+    
+    node* create_node(void)
+    {
+      auto ptr = node_traits::allocate(alloc_, 1);
+      try {
+        node_traits::construct(alloc_, ptr);
+      } catch (...) {
+        node_traits::deallocate(alloc_, ptr, 1);
+        throw;
+      }
+      return ptr;
+    }
+    
+    void destroy_node(node* ptr)
+    {
+      node_traits::destroy(alloc_, ptr);
+      node_traits::deallocate(alloc_, ptr, 1);
+    }
+    
+    node* take_node(void)
+    {
+      if (free_ == nullptr) {
+        return create_node();
+      }
+      
+      auto ptr = free_;
+      free_ = ptr->next;
+      --free_count_;
+      
+      ptr->next = nullptr;
+      return ptr;
+    }
+    
+    void release_node(node* ptr)
+    {
+      ptr->next = free_;
+      free_ = ptr;
+      ++free_count_;
+    }
+    
+    // the slow paths are kept out of line so push() and pop() stay
+    // small enough to be inlined everywhere
+    template <typename ...Args>
+    void emplace_into_new_node(Args&& ...args)
+    {
+      auto next = take_node();
+      try {
+        new(next->begin()) value_type(std::forward<Args>(args)...);
+      } catch (...) {
+        release_node(next);
+        throw;
+      }
+      
+      tail_->next = next;
+      tail_ = next;
+      back_ = next->begin() + 1;
+      ++size_;
+    }
+    
+    void drop_head(void)
+    {
+      auto drained = head_;
+      head_ = head_->next;
+      front_ = head_->begin();
+      release_node(drained);
+    }
+    
+    static void destroy_range(value_type* first, value_type* last)
+    {
+      for (; first != last; ++first) {
+        first->~value_type();
+      }
+    }
+  
+  public:
+    segmented_queue(void)
+      : segmented_queue(Allocator{})
+    {}
+    
+    explicit segmented_queue(Allocator const& alloc)
+      : alloc_{alloc}
+      , head_{create_node()}
+      , tail_{head_}
+      , front_{head_->begin()}
+      , back_{head_->begin()}
+      , size_{0}
+      , free_{nullptr}
+      , free_count_{0}
+    {}
+    
+    segmented_queue(segmented_queue const&) = delete;
+    segmented_queue& operator=(segmented_queue const&) = delete;
+    
+    ~segmented_queue(void)
+    {
+      while (head_ != tail_) {
+        auto tmp = head_;
+        head_ = head_->next;
+        destroy_range(front_, tmp->end());
+        destroy_node(tmp);
+        front_ = head_->begin();
+      }
+      destroy_range(front_, back_);
+      destroy_node(head_);
+      
+      shrink_to_fit();
+    }
+    
+    // Element Access
+    reference front(void)
+    {
+      return *front_;
+    }
+    
+    const_reference front(void) const
+    {
+      return *front_;
+    }
+    
+    reference back(void)
+    {
+      return *(back_ - 1);
+    }
+    
+    const_reference back(void) const
+    {
+      return *(back_ - 1);
+    }
+    
+    // Capacity
+    size_type size(void) const
+    {
+      return size_;
+    }
+    
+    bool empty(void) const
+    {
+      return size_ == 0;
+    }
+    
+    // nodes in use plus the ones sitting on the free list
+    size_type node_count(void) const
+    {
+      size_type count = free_count_;
+      for (auto curr = head_; curr != nullptr; curr = curr->next) {
+        ++count;
+      }
+      return count;
+    }
+    
+    // gives the free list back to the allocator
+    void shrink_to_fit(void)
+    {
+      while (free_ != nullptr) {
+        auto tmp = free_;
+        free_ = free_->next;
+        destroy_node(tmp);
+      }
+      free_count_ = 0;
+    }
+    
+    // Modifiers
+    template <typename ...Args>
+    void emplace(Args&& ...args)
+    {
+      if (back_ == tail_->end()) {
+        emplace_into_new_node(std::forward<Args>(args)...);
+        return;
+      }
+      
+      new(back_) value_type(std::forward<Args>(args)...);
+      ++back_;
+      ++size_;
+    }
+    
+    void push(const_reference val)
+    {
+      emplace(val);
+    }
+    
+    void push(value_type&& val)
+    {
+      emplace(std::move(val));
+    }
+    
+    void pop(void)
+    {
+      front_->~value_type();
+      ++front_;
+      --size_;
+      
+      // an emptied queue just starts over at the front of its node
+      if (size_ == 0) {
+        front_ = head_->begin();
+        back_ = front_;
+        return;
+      }
+      
+      if (front_ == head_->end()) {
+        drop_head();
+      }
+    }
+  };
+}
+
+#endif // REGULUS_SEGMENTED_QUEUE_HPP_
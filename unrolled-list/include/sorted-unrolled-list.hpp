@@ -0,0 +1,477 @@
+#ifndef REGULUS_SORTED_UNROLLED_LIST_HPP_
+#define REGULUS_SORTED_UNROLLED_LIST_HPP_
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "static-vector.hpp"
+#include "unrolled-list.hpp"
+
+namespace regulus
+{
+  /**
+    * An ordered multiset stored as sorted runs in unrolled_list style
+    * nodes. Every node keeps a copy of its first and last key in its
+    * header and the nodes are kept in order in a directory, so a
+    * lookup binary searches the directory (touching one header line
+    * per step) and then binary searches inside a single node.
+    *
+    * Full nodes get split in half, although an element that belongs
+    * behind the last element of a full node just starts a new node
+    * or goes to the end of the previous one when there's room.
+    * Nodes that drop under a quarter full are merged with a neighbour
+    * that's under it too.
+    *
+    * Iterators are invalidated by every insert and erase.
+    */
+  template <
+    typename T,
+    typename Compare = std::less<T>,
+    std::size_t NodeSize = default_node_size<T>::value,
+    typename Allocator = std::allocator<T>
+  >
+  class sorted_unrolled_list
+  {
+  public:
+    typedef T                 value_type;
+    typedef std::size_t       size_type;
+    typedef std::ptrdiff_t    difference_type;
+    typedef value_type const& const_reference;
+    typedef value_type const* const_pointer;
+    typedef Compare           key_compare;
+    typedef Allocator         allocator_type;
+    
+    std::size_t const static node_size = NodeSize;
+    
+    static_assert(node_size >= 4, "Nodes need room for at least 4 elements");
+  
+  private:
+    struct node
+    {
+    public:
+      // copy of vec.back(), all the search looks at
+      value_type last_key;
+      
+      static_vector<T, node_size> vec;
+    
+    public:
+      void update_keys(void)
+      {
+        last_key = vec.back();
+      }
+    };
+    
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<node>
+      node_allocator;
+    typedef std::allocator_traits<node_allocator> node_traits;
+  
+  public:
+    class const_iterator :
+      public std::iterator<
+        std::bidirectional_iterator_tag, value_type,
+        difference_type, const_pointer, const_reference>
+    {
+    private:
+      friend class sorted_unrolled_list;
+      
+      sorted_unrolled_list const* list_;
+      size_type node_;
+      size_type pos_;
+    
+    public:
+      const_iterator(
+        sorted_unrolled_list const* list, size_type const node, size_type const pos)
+        : list_{list}
+        , node_{node}
+        , pos_{pos}
+      {}
+      
+      const_reference operator*(void) const
+      {
+        return list_->nodes_[node_]->vec[pos_];
+      }
+      
+      const_pointer operator->(void) const
+      {
+        return std::addressof(**this);
+      }
+      
+      bool operator==(const_iterator const& other) const
+      {
+        return node_ == other.node_ && pos_ == other.pos_;
+      }
+      
+      bool operator!=(const_iterator const& other) const
+      {
+        return !(*this == other);
+      }
+      
+      const_iterator& operator++(void)
+      {
+        if (++pos_ == list_->nodes_[node_]->vec.size()) {
+          ++node_;
+          pos_ = 0;
+        }
+        return *this;
+      }
+      
+      const_iterator operator++(int)
+      {
+        auto tmp = *this;
+        ++(*this);
+        return tmp;
+      }
+      
+      const_iterator& operator--(void)
+      {
+        if (pos_ == 0) {
+          --node_;
+          pos_ = list_->nodes_[node_]->vec.size();
+        }
+        --pos_;
+        return *this;
+      }
+      
+      const_iterator operator--(int)
+      {
+        auto tmp = *this;
+        --(*this);
+        return tmp;
+      }
+    };
+    
+    typedef const_iterator iterator;
+  
+  private:
+    node_allocator     alloc_;
+    key_compare        comp_;
+    std::vector<node*> nodes_;
+    size_type          size_;
+    
+    node* create_node(void)
+    {
+      auto ptr = node_traits::allocate(alloc_, 1);
+      try {
+        node_traits::construct(alloc_, ptr);
+      } catch (...) {
+        node_traits::deallocate(alloc_, ptr, 1);
+        throw;
+      }
+      return ptr;
+    }
+    
+    void destroy_node(node* ptr)
+    {
+      node_traits::destroy(alloc_, ptr);
+      node_traits::deallocate(alloc_, ptr, 1);
+    }
+    
+    // puts a fresh node into the directory at idx
+    node* insert_node(size_type const idx)
+    {
+      auto ptr = create_node();
+      try {
+        nodes_.insert(nodes_.begin() + idx, ptr);
+      } catch (...) {
+        destroy_node(ptr);
+        throw;
+      }
+      return ptr;
+    }
+    
+    void remove_node(size_type const idx)
+    {
+      destroy_node(nodes_[idx]);
+      nodes_.erase(nodes_.begin() + idx);
+    }
+    
+    // the first node whose last key isn't less than key
+    size_type lower_node(value_type const& key) const
+    {
+      auto it = std::partition_point(
+        nodes_.begin(), nodes_.end(),
+        [this, &key](node const* curr)
+        {
+          return comp_(curr->last_key, key);
+        });
+      return it - nodes_.begin();
+    }
+    
+    // the first node whose last key is greater than key
+    size_type upper_node(value_type const& key) const
+    {
+      auto it = std::partition_point(
+        nodes_.begin(), nodes_.end(),
+        [this, &key](node const* curr)
+        {
+          return !comp_(key, curr->last_key);
+        });
+      return it - nodes_.begin();
+    }
+    
+    // only end() is allowed to sit one past the last element of a node
+    const_iterator make_iterator(size_type idx, size_type pos) const
+    {
+      if (idx < nodes_.size() && pos == nodes_[idx]->vec.size()) {
+        ++idx;
+        pos = 0;
+      }
+      return const_iterator{this, idx, pos};
+    }
+    
+    // the element at pos of nodes_[idx] just left, clean up after it
+    const_iterator settle_erase(size_type idx, size_type pos)
+    {
+      auto curr = nodes_[idx];
+      if (curr->vec.size() == 0) {
+        remove_node(idx);
+        return const_iterator{this, idx, 0};
+      }
+      
+      curr->update_keys();
+      
+      auto const threshold = node_size / 4;
+      if (curr->vec.size() < threshold) {
+        if (idx + 1 < nodes_.size() && nodes_[idx + 1]->vec.size() < threshold) {
+          curr->vec.splice(nodes_[idx + 1]->vec, 0);
+          curr->update_keys();
+          remove_node(idx + 1);
+        } else if (idx > 0 && nodes_[idx - 1]->vec.size() < threshold) {
+          auto prev = nodes_[idx - 1];
+          pos += prev->vec.size();
+          prev->vec.splice(curr->vec, 0);
+          prev->update_keys();
+          remove_node(idx);
+          --idx;
+        }
+      }
+      
+      return make_iterator(idx, pos);
+    }
+  
+  public:
+    sorted_unrolled_list(void)
+      : sorted_unrolled_list(Compare{})
+    {}
+    
+    explicit sorted_unrolled_list(
+      Compare const& comp, Allocator const& alloc = Allocator{})
+      : alloc_{alloc}
+      , comp_{comp}
+      , size_{0}
+    {}
+    
+    /**
+      * Sorts a copy of the range once and packs it into full nodes
+      * instead of inserting one element at a time.
+      */
+    template <
+      typename InputIt,
+      typename = typename std::iterator_traits<InputIt>::iterator_category
+    >
+    sorted_unrolled_list(
+      InputIt first, InputIt last,
+      Compare const& comp = Compare{}, Allocator const& alloc = Allocator{})
+      : sorted_unrolled_list(comp, alloc)
+    {
+      std::vector<value_type> sorted(first, last);
+      std::stable_sort(sorted.begin(), sorted.end(), comp_);
+      
+      nodes_.reserve((sorted.size() + node_size - 1) / node_size);
+      for (size_type i = 0; i < sorted.size(); i += node_size) {
+        auto const count = std::min(size_type{node_size}, sorted.size() - i);
+        auto curr = insert_node(nodes_.size());
+        curr->vec.insert(
+          curr->vec.end(),
+          sorted.begin() + i, sorted.begin() + i + count);
+        curr->update_keys();
+        size_ += count;
+      }
+    }
+    
+    sorted_unrolled_list(sorted_unrolled_list const&) = delete;
+    sorted_unrolled_list& operator=(sorted_unrolled_list const&) = delete;
+    
+    ~sorted_unrolled_list(void)
+    {
+      clear();
+    }
+    
+    // Iterators
+    const_iterator begin(void) const
+    {
+      return const_iterator{this, 0, 0};
+    }
+    
+    const_iterator end(void) const
+    {
+      return const_iterator{this, nodes_.size(), 0};
+    }
+    
+    // Capacity
+    size_type size(void) const
+    {
+      return size_;
+    }
+    
+    bool empty(void) const
+    {
+      return size_ == 0;
+    }
+    
+    size_type node_count(void) const
+    {
+      return nodes_.size();
+    }
+    
+    // Lookup
+    const_iterator lower_bound(value_type const& key) const
+    {
+      auto const idx = lower_node(key);
+      if (idx == nodes_.size()) {
+        return end();
+      }
+      
+      auto const& vec = nodes_[idx]->vec;
+      auto const ptr = std::lower_bound(vec.begin(), vec.end(), key, comp_);
+      return const_iterator{this, idx, (size_type ) (ptr - vec.begin())};
+    }
+    
+    const_iterator upper_bound(value_type const& key) const
+    {
+      auto const idx = upper_node(key);
+      if (idx == nodes_.size()) {
+        return end();
+      }
+      
+      auto const& vec = nodes_[idx]->vec;
+      auto const ptr = std::upper_bound(vec.begin(), vec.end(), key, comp_);
+      return const_iterator{this, idx, (size_type ) (ptr - vec.begin())};
+    }
+    
+    std::pair<const_iterator, const_iterator> equal_range(
+      value_type const& key) const
+    {
+      return {lower_bound(key), upper_bound(key)};
+    }
+    
+    const_iterator find(value_type const& key) const
+    {
+      auto it = lower_bound(key);
+      if (it != end() && !comp_(key, *it)) {
+        return it;
+      }
+      return end();
+    }
+    
+    bool contains(value_type const& key) const
+    {
+      return find(key) != end();
+    }
+    
+    size_type count(value_type const& key) const
+    {
+      auto range = equal_range(key);
+      return std::distance(range.first, range.second);
+    }
+    
+    // Modifiers
+    /**
+      * Inserts val behind any elements equal to it and returns an
+      * iterator to it.
+      */
+    const_iterator insert(value_type const& val)
+    {
+      if (nodes_.empty()) {
+        insert_node(0);
+      }
+      
+      // an element greater than everything goes to the last node
+      auto idx = std::min(upper_node(val), nodes_.size() - 1);
+      auto curr = nodes_[idx];
+      auto pos = (size_type ) (
+        std::upper_bound(curr->vec.begin(), curr->vec.end(), val, comp_) -
+        curr->vec.begin());
+      
+      if (curr->vec.size() == node_size) {
+        if (pos == 0 && idx > 0 && nodes_[idx - 1]->vec.size() < node_size) {
+          // it fits right behind the previous node's elements
+          --idx;
+          curr = nodes_[idx];
+          pos = curr->vec.size();
+        } else if (pos == node_size) {
+          // it goes behind all of them, so start a new node
+          ++idx;
+          curr = insert_node(idx);
+          pos = 0;
+        } else {
+          // val may be one of the elements the split is about to move
+          value_type tmp{val};
+          
+          auto const split = node_size / 2;
+          auto upper = insert_node(idx + 1);
+          upper->vec.splice(curr->vec, split);
+          curr->update_keys();
+          upper->update_keys();
+          
+          if (pos > split) {
+            ++idx;
+            curr = upper;
+            pos -= split;
+          }
+          
+          curr->vec.emplace(curr->vec.begin() + pos, std::move(tmp));
+          curr->update_keys();
+          ++size_;
+          return const_iterator{this, idx, pos};
+        }
+      }
+      
+      curr->vec.insert(curr->vec.begin() + pos, val);
+      curr->update_keys();
+      ++size_;
+      return const_iterator{this, idx, pos};
+    }
+    
+    template <typename ...Args>
+    const_iterator emplace(Args&& ...args)
+    {
+      return insert(value_type(std::forward<Args>(args)...));
+    }
+    
+    // erases the element at it, returns an iterator to the one after it
+    const_iterator erase(const_iterator it)
+    {
+      auto& vec = nodes_[it.node_]->vec;
+      vec.erase(vec.begin() + it.pos_);
+      --size_;
+      return settle_erase(it.node_, it.pos_);
+    }
+    
+    // erases every element equal to key, returns how many there were
+    size_type erase(value_type const& key)
+    {
+      size_type erased = 0;
+      for (auto it = lower_bound(key); it != end() && !comp_(key, *it); ) {
+        it = erase(it);
+        ++erased;
+      }
+      return erased;
+    }
+    
+    void clear(void)
+    {
+      for (auto curr : nodes_) {
+        destroy_node(curr);
+      }
+      nodes_.clear();
+      size_ = 0;
+    }
+  };
+}
+
+#endif // REGULUS_SORTED_UNROLLED_LIST_HPP_
@@ -2,11 +2,40 @@
 #define REGULUS_STATIC_VECTOR_HPP_
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
 #include <type_traits>
 #include <stdexcept>
 #include <iterator>
+#include <initializer_list>
+#include <memory>
 #include <algorithm>
 
+/**
+  * With C++20 a static_vector of trivial types can be built and changed
+  * in constant expressions, so lookup tables can be generated at compile
+  * time into read-only data instead of at startup. Those types are
+  * stored as a plain array of T instead of raw storage and everything
+  * that would otherwise memcpy or use placement new switches to
+  * std::construct_at while being constant evaluated.
+  *
+  * Define REGULUS_CONSTEXPR_STATIC_VECTOR as 0 to turn it off.
+  */
+#ifndef REGULUS_CONSTEXPR_STATIC_VECTOR
+#if defined(__cpp_lib_is_constant_evaluated) && defined(__cpp_lib_constexpr_dynamic_alloc)
+#define REGULUS_CONSTEXPR_STATIC_VECTOR 1
+#else
+#define REGULUS_CONSTEXPR_STATIC_VECTOR 0
+#endif
+#endif
+
+#if REGULUS_CONSTEXPR_STATIC_VECTOR
+#define REGULUS_CONSTEXPR20 constexpr
+#else
+#define REGULUS_CONSTEXPR20
+#endif
+
 /**
   * This implementation is based off of the
   * example found at:
@@ -14,6 +43,204 @@
   */
 namespace regulus
 {
+  /**
+    * Relocating an object means move-constructing it into
+    * new storage and destroying the original. For a lot of
+    * types this is the same thing as copying the bytes over
+    * so we let the containers use memmove/memcpy for those.
+    *
+    * Trivially copyable types are relocatable by default,
+    * other types can opt in by specializing this trait.
+    */
+  template <typename T>
+  struct is_trivially_relocatable
+    : std::integral_constant<bool, std::is_trivially_copyable<T>::value>
+  {};
+  
+  namespace detail
+  {
+#if REGULUS_CONSTEXPR_STATIC_VECTOR
+    template <typename T>
+    struct has_literal_storage
+      : std::integral_constant<
+          bool,
+          std::is_trivially_default_constructible<T>::value &&
+          std::is_trivially_destructible<T>::value>
+    {};
+#else
+    template <typename T>
+    struct has_literal_storage : std::false_type {};
+#endif
+    
+    // placement new isn't allowed in constant expressions but
+    // std::construct_at is
+    template <typename T, typename ...Args>
+    REGULUS_CONSTEXPR20 inline T* construct_at(T* ptr, Args&& ...args)
+    {
+#if REGULUS_CONSTEXPR_STATIC_VECTOR
+      if (std::is_constant_evaluated()) {
+        return std::construct_at(ptr, T{std::forward<Args>(args)...});
+      }
+#endif
+      return new(ptr) T{std::forward<Args>(args)...};
+    }
+    
+    // trivially destructible elements are left alone, so slots of a
+    // constant evaluated static_vector never hold objects whose
+    // lifetime has ended
+    template <typename T>
+    REGULUS_CONSTEXPR20 inline void destroy_at(T*, std::true_type)
+    {}
+    
+    template <typename T>
+    REGULUS_CONSTEXPR20 inline void destroy_at(T* ptr, std::false_type)
+    {
+      ptr->~T();
+    }
+    
+    template <typename T>
+    REGULUS_CONSTEXPR20 inline void destroy_at(T* ptr)
+    {
+      destroy_at(ptr, std::is_trivially_destructible<T>{});
+    }
+    
+    // comparing pointers into different arrays isn't a constant
+    // expression, so at compile time we look for ptr one by one
+    template <typename T>
+    REGULUS_CONSTEXPR20 inline bool points_into(
+      T const* ptr, T const* first, T const* last)
+    {
+#if REGULUS_CONSTEXPR_STATIC_VECTOR
+      if (std::is_constant_evaluated()) {
+        for (; first != last; ++first) {
+          if (first == ptr) {
+            return true;
+          }
+        }
+        return false;
+      }
+#endif
+      return ptr >= first && ptr < last;
+    }
+    
+    template <typename T>
+    inline void relocate(T* first, T* last, T* dst, std::true_type)
+    {
+      std::memmove(
+        static_cast<void*>(dst),
+        static_cast<void const*>(first),
+        (last - first) * sizeof(T));
+    }
+    
+    template <typename T>
+    REGULUS_CONSTEXPR20 inline void relocate(T* first, T* last, T* dst, std::false_type)
+    {
+      if (dst == first) {
+        return;
+      }
+      
+      // the ranges may overlap so we have to pick the direction
+      // that never overwrites an element we haven't moved yet
+      if (!points_into<T>(dst, first, last)) {
+        for (; first != last; ++first, ++dst) {
+          detail::construct_at(dst, std::move(*first));
+          detail::destroy_at(first);
+        }
+      } else {
+        dst += (last - first);
+        while (last != first) {
+          --last;
+          --dst;
+          detail::construct_at(dst, std::move(*last));
+          detail::destroy_at(last);
+        }
+      }
+    }
+    
+    /**
+      * Relocate the objects in [first, last) to the uninitialized
+      * memory starting at dst. The source objects are dead afterwards
+      * and the two ranges are allowed to overlap.
+      */
+    template <typename T>
+    REGULUS_CONSTEXPR20 inline void relocate(T* first, T* last, T* dst)
+    {
+#if REGULUS_CONSTEXPR_STATIC_VECTOR
+      if (std::is_constant_evaluated()) {
+        relocate(first, last, dst, std::false_type{});
+        return;
+      }
+#endif
+      relocate(
+        first, last, dst,
+        std::integral_constant<bool, is_trivially_relocatable<T>::value>{});
+    }
+    
+    // copying out of a range of T into T storage can be done with
+    // a single memcpy if T is trivially copyable
+    template <typename It, typename T>
+    struct is_memcpyable
+      : std::integral_constant<
+          bool,
+          std::is_pointer<It>::value &&
+          std::is_same<std::remove_cv_t<std::remove_pointer_t<It>>, T>::value &&
+          std::is_trivially_copyable<T>::value>
+    {};
+    
+    template <typename T>
+    inline T* uninitialized_copy(T const* first, T const* last, T* dst, std::true_type)
+    {
+      auto const count = last - first;
+      std::memcpy(
+        static_cast<void*>(dst),
+        static_cast<void const*>(first),
+        count * sizeof(T));
+      return dst + count;
+    }
+    
+    template <typename InputIt, typename T>
+    inline T* uninitialized_copy(InputIt first, InputIt last, T* dst, std::false_type)
+    {
+      return std::uninitialized_copy(first, last, dst);
+    }
+    
+    template <typename InputIt, typename T>
+    REGULUS_CONSTEXPR20 inline T* uninitialized_copy(InputIt first, InputIt last, T* dst)
+    {
+#if REGULUS_CONSTEXPR_STATIC_VECTOR
+      if (std::is_constant_evaluated()) {
+        for (; first != last; ++first, ++dst) {
+          detail::construct_at(dst, *first);
+        }
+        return dst;
+      }
+#endif
+      return uninitialized_copy(first, last, dst, is_memcpyable<InputIt, T>{});
+    }
+    
+    template <typename T>
+    REGULUS_CONSTEXPR20 inline void uninitialized_fill(T* first, T* last, T const& val)
+    {
+#if REGULUS_CONSTEXPR_STATIC_VECTOR
+      if (std::is_constant_evaluated()) {
+        for (; first != last; ++first) {
+          detail::construct_at(first, val);
+        }
+        return;
+      }
+#endif
+      std::uninitialized_fill(first, last, val);
+    }
+    
+    // the smallest unsigned type able to count up to N
+    template <std::size_t N>
+    using smallest_size_t =
+      std::conditional_t<(N <= UINT8_MAX), std::uint8_t,
+      std::conditional_t<(N <= UINT16_MAX), std::uint16_t,
+      std::conditional_t<(N <= UINT32_MAX), std::uint32_t,
+      std::uint64_t>>>;
+  }
+  
   template <
     typename T,
     std::size_t N,
@@ -21,9 +248,6 @@ namespace regulus
   >
   class static_vector
   {
-  private:
-      friend class iterator;
-      
   public:
     // Member Types
     typedef T                 value_type;
@@ -32,137 +256,305 @@ namespace regulus
     typedef value_type&       reference;
     typedef value_type const& const_reference;
     typedef value_type*       pointer;
-    typedef value_type const* const_pointer;    
+    typedef value_type const* const_pointer;
     
+    // The storage is contiguous so plain pointers make for the
+    // best iterators. Compilers see straight through them and
+    // will happily vectorize loops over a static_vector.
+    typedef pointer                               iterator;
+    typedef const_pointer                         const_iterator;
+    typedef std::reverse_iterator<iterator>       reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+  
   private:
-    // We use an array of POD types suitable for storing T
-    std::aligned_storage_t<sizeof(T), alignof(T)> data_[N];
-    size_type                                     size_;
+    // The count only needs to be as wide as N and sits in front of
+    // the data so small vectors don't pay for a full std::size_t
+    // plus padding and the count shares a cache line with the first
+    // elements.
+    detail::smallest_size_t<N> size_;
+    
+    // We use an array of POD types suitable for storing T, or of T
+    // itself when it's trivial enough to work in constant expressions
+    typedef std::conditional_t<
+      detail::has_literal_storage<T>::value,
+      value_type,
+      std::aligned_storage_t<sizeof(T), alignof(T)>> storage_type;
+    
+    storage_type data_[N];
+    
+    static REGULUS_CONSTEXPR20 pointer as_pointer(value_type* ptr)
+    {
+      return ptr;
+    }
+    
+    static REGULUS_CONSTEXPR20 const_pointer as_pointer(value_type const* ptr)
+    {
+      return ptr;
+    }
+    
+    template <typename Storage>
+    static pointer as_pointer(Storage* ptr)
+    {
+      return reinterpret_cast<pointer>(ptr);
+    }
+    
+    template <typename Storage>
+    static const_pointer as_pointer(Storage const* ptr)
+    {
+      return reinterpret_cast<const_pointer>(ptr);
+    }
     
     // 2 small helper functions for reading out of the array
-    inline pointer address_at(size_type const pos)
+    REGULUS_CONSTEXPR20 inline pointer address_at(size_type const pos)
     {
-      return reinterpret_cast<pointer>(data_ + pos);
+      return as_pointer(data_ + pos);
     }
     
-    inline const_pointer caddress_at(size_type const pos) const
+    REGULUS_CONSTEXPR20 inline const_pointer caddress_at(size_type const pos) const
     {
-      return reinterpret_cast<const_pointer>(data_ + pos);
+      return as_pointer(data_ + pos);
     }
     
-  public:
-    class iterator :
-      public std::iterator<std::random_access_iterator_tag, value_type>
+    // destroys the elements from count on, unlike resize() this
+    // never needs T to be default constructible
+    REGULUS_CONSTEXPR20 void truncate(size_type const count)
     {
-    private:
-      friend class static_vector;
-      
-      static_vector& vec_;
-      difference_type pos_;
-            
-    public:
-      iterator(static_vector& vec, difference_type const pos)
-        : vec_{vec}
-        , pos_{pos}
-      {}
-      
-      bool operator==(iterator const& other) const
-      {
-        return (pos_ == other.pos_);
-      }
-      
-      bool operator!=(iterator const& other) const
-      {
-        return !(*this == other);
+      while (size_ > count) {
+        pop_back();
       }
-      
-      reference operator*(void)
-      {
-        return *(vec_.address_at(pos_));
+    }
+    
+    /**
+      * A constexpr static_vector has to come out of constant evaluation
+      * with every slot initialized, live or not, so they're value
+      * initialized up front there. At runtime the slots past size()
+      * are left alone and construction stays free.
+      */
+    REGULUS_CONSTEXPR20 void prepare_storage(void)
+    {
+#if REGULUS_CONSTEXPR_STATIC_VECTOR
+      if constexpr (detail::has_literal_storage<T>::value) {
+        if (std::is_constant_evaluated()) {
+          for (auto& slot : data_) {
+            detail::construct_at(std::addressof(slot));
+          }
+        }
       }
-      
-      pointer operator->(void)
-      {
-        return vec_.address_at(pos_);
+#endif
+    }
+    
+    REGULUS_CONSTEXPR20 inline void check_capacity(size_type const count) const
+    {
+      if (count > N - size_) {
+        throw std::length_error{"Capacity exceeded!"};
       }
+    }
+    
+    // when we know the length of the range we only need to check the
+    // capacity and shift the tail once before copying everything
+    template <typename ForwardIt>
+    REGULUS_CONSTEXPR20 iterator insert_range(
+      const_iterator it, ForwardIt first, ForwardIt last,
+      std::forward_iterator_tag)
+    {
+      auto const count = static_cast<size_type>(std::distance(first, last));
+      check_capacity(count);
       
-      iterator& operator++(void)
-      {
-        ++pos_;
-        return *this;
-      }
+      auto const pos = address_at(it - cbegin());
+      auto const old_end = end();
       
-      iterator& operator++(int)
-      {
-        auto tmp = *this;
-        ++(*this);
-        return tmp;
+      detail::relocate(pos, old_end, pos + count);
+      try {
+        detail::uninitialized_copy(first, last, pos);
+      } catch (...) {
+        detail::relocate(pos + count, old_end + count, pos);
+        throw;
       }
       
-      iterator& operator--(void)
-      {
-        --pos_;
-        return *this;
+      size_ += count;
+      return pos;
+    }
+    
+    // moves every element of other over, other ends up empty; trivially
+    // relocatable elements go over in one memcpy of just the live ones
+    REGULUS_CONSTEXPR20 void steal(static_vector& other, std::true_type) noexcept
+    {
+#if REGULUS_CONSTEXPR_STATIC_VECTOR
+      if (std::is_constant_evaluated()) {
+        detail::uninitialized_copy(other.begin(), other.end(), address_at(0));
+        size_ = other.size_;
+        other.size_ = 0;
+        return;
       }
-      
-      iterator& operator--(int)
-      {
-        auto tmp = *this;
-        --(*this);
-        return tmp;
+#endif
+      std::memcpy(
+        static_cast<void*>(address_at(0)),
+        static_cast<void const*>(other.caddress_at(0)),
+        other.size_ * sizeof(T));
+      size_ = other.size_;
+      other.size_ = 0;
+    }
+    
+    REGULUS_CONSTEXPR20 void steal(static_vector& other, std::false_type)
+    {
+      auto const first = address_at(0);
+      auto ptr = first;
+      try {
+        for (auto src = other.begin(); src != other.end(); ++src, ++ptr) {
+          detail::construct_at(ptr, std::move(*src));
+        }
+      } catch (...) {
+        while (ptr != first) {
+          detail::destroy_at(--ptr);
+        }
+        throw;
       }
-      
-      iterator& operator+(difference_type const pos)
-      {
-        pos_ += pos;
-        return *this;
+      size_ = other.size_;
+      other.clear();
+    }
+    
+    typedef std::integral_constant<bool, is_trivially_relocatable<T>::value>
+      relocatable;
+    
+    // arithmetic elements are cheaper to copy unconditionally than to
+    // branch on, so every element gets written and the count of kept
+    // elements only advances past the ones that stay
+    template <typename Pred>
+    REGULUS_CONSTEXPR20 size_type compact(Pred& pred, std::true_type)
+    {
+      auto const ptr = address_at(0);
+      size_type kept = 0;
+      for (size_type i = 0; i < size_; ++i) {
+        auto const val = ptr[i];
+        ptr[kept] = val;
+        kept += !pred(val);
       }
+      return kept;
+    }
+    
+    template <typename Pred>
+    REGULUS_CONSTEXPR20 size_type compact(Pred& pred, std::false_type)
+    {
+      auto const last = std::remove_if(
+        begin(), end(),
+        [&pred](const_reference val)
+        {
+          return pred(val);
+        });
+      return last - begin();
+    }
+    
+    static constexpr bool nothrow_move =
+      is_trivially_relocatable<T>::value ||
+      std::is_nothrow_move_constructible<T>::value;
+    
+    // single-pass ranges get appended and rotated into place
+    template <typename InputIt>
+    REGULUS_CONSTEXPR20 iterator insert_range(
+      const_iterator it, InputIt first, InputIt last,
+      std::input_iterator_tag)
+    {
+      auto const offset = it - cbegin();
+      auto const old_size = size_;
       
-      iterator& operator-(difference_type const pos)
-      {
-        pos_ -= pos;
-        return *this;
+      for (; first != last; ++first) {
+        check_capacity(1);
+        emplace_back(*first);
       }
       
-      difference_type operator-(iterator other)
-      {
-        return pos_ - other.pos_;
-      }
-    };
-    
+      std::rotate(begin() + offset, begin() + old_size, end());
+      return begin() + offset;
+    }
+  
   public:
     // this constructor may be unnecessary if
     // size_type default-constructs to 0
-    static_vector(void)
+    REGULUS_CONSTEXPR20 static_vector(void)
       : size_{0}
-    {}
+    {
+      prepare_storage();
+    }
     
-    static_vector(const_reference init)
+    REGULUS_CONSTEXPR20 static_vector(const_reference init)
     {
       for (auto ptr = address_at(0); ptr < address_at(N); ++ptr) {
-        new(ptr) value_type{init};
+        detail::construct_at(ptr, init);
       }
       size_ = N;
     }
     
-    ~static_vector(void)
+    REGULUS_CONSTEXPR20 static_vector(std::initializer_list<value_type> init)
+      : size_{0}
+    {
+      prepare_storage();
+      insert(cend(), init.begin(), init.end());
+    }
+    
+    /**
+      * Copies and moves only ever touch the size() live elements,
+      * never the whole capacity. A moved-from static_vector is empty.
+      */
+    REGULUS_CONSTEXPR20 static_vector(static_vector const& other)
+      : size_{0}
+    {
+      prepare_storage();
+      detail::uninitialized_copy(other.begin(), other.end(), address_at(0));
+      size_ = other.size_;
+    }
+    
+    REGULUS_CONSTEXPR20 static_vector(static_vector&& other) noexcept(nothrow_move)
+      : size_{0}
+    {
+      prepare_storage();
+      steal(other, relocatable{});
+    }
+    
+    REGULUS_CONSTEXPR20 static_vector& operator=(static_vector const& other)
+    {
+      if (this == std::addressof(other)) {
+        return *this;
+      }
+      
+      // assign over the elements both have, then construct or destroy
+      // whatever's left over
+      auto const common = std::min(size_type{size_}, size_type{other.size_});
+      std::copy(other.begin(), other.begin() + common, begin());
+      if (other.size_ > size_) {
+        detail::uninitialized_copy(other.begin() + common, other.end(), end());
+        size_ = other.size_;
+      } else {
+        truncate(other.size_);
+      }
+      return *this;
+    }
+    
+    REGULUS_CONSTEXPR20 static_vector& operator=(static_vector&& other) noexcept(nothrow_move)
+    {
+      if (this != std::addressof(other)) {
+        clear();
+        steal(other, relocatable{});
+      }
+      return *this;
+    }
+    
+    REGULUS_CONSTEXPR20 ~static_vector(void)
     {
       auto const ptr = caddress_at(0);
       for (size_type i = 0; i < size_; ++i) {
-        (ptr + i)->~value_type();
+        detail::destroy_at(ptr + i);
       }
     }
     
     // Element Access
-    reference at(size_type const pos)
+    REGULUS_CONSTEXPR20 reference at(size_type const pos)
     {
       if (pos >= size_) {
         throw std::out_of_range{"Index is out of bounds!"};
       }
       return this->operator[](pos);
     }
-        
-    const_reference at(size_type const pos) const
+    
+    REGULUS_CONSTEXPR20 const_reference at(size_type const pos) const
     {
       if (pos >= size_) {
         throw std::out_of_range{"Index is out of bounds!"};
@@ -170,125 +562,396 @@ namespace regulus
       return this->operator[](pos);
     }
     
-    reference operator[](size_type const pos)
+    REGULUS_CONSTEXPR20 reference operator[](size_type const pos)
     {
       return *address_at(pos);
     }
-     
-    const_reference operator[](size_type const pos) const
+    
+    REGULUS_CONSTEXPR20 const_reference operator[](size_type const pos) const
     {
       return *caddress_at(pos);
     }
     
-    reference front(void)
+    REGULUS_CONSTEXPR20 reference front(void)
     {
       return this->operator[](0);
     }
     
-    const_reference front(void) const
+    REGULUS_CONSTEXPR20 const_reference front(void) const
     {
       return this->operator[](0);
     }
     
-    reference back(void)
+    REGULUS_CONSTEXPR20 reference back(void)
     {
       return this->operator[](size_ - 1);
     }
     
-    const_reference back(void) const
+    REGULUS_CONSTEXPR20 const_reference back(void) const
     {
       return this->operator[](size_ - 1);
     }
     
+    REGULUS_CONSTEXPR20 pointer data(void)
+    {
+      return address_at(0);
+    }
+    
+    REGULUS_CONSTEXPR20 const_pointer data(void) const
+    {
+      return caddress_at(0);
+    }
+    
     // Iterators
-    iterator begin(void)
+    REGULUS_CONSTEXPR20 iterator begin(void)
+    {
+      return address_at(0);
+    }
+    
+    REGULUS_CONSTEXPR20 const_iterator begin(void) const
+    {
+      return caddress_at(0);
+    }
+    
+    REGULUS_CONSTEXPR20 const_iterator cbegin(void) const
+    {
+      return caddress_at(0);
+    }
+    
+    REGULUS_CONSTEXPR20 iterator end(void)
+    {
+      return address_at(size_);
+    }
+    
+    REGULUS_CONSTEXPR20 const_iterator end(void) const
+    {
+      return caddress_at(size_);
+    }
+    
+    REGULUS_CONSTEXPR20 const_iterator cend(void) const
     {
-      return iterator{*this, 0};
+      return caddress_at(size_);
     }
     
-    iterator end(void)
+    REGULUS_CONSTEXPR20 reverse_iterator rbegin(void)
     {
-      return iterator{*this, (difference_type ) size_};
+      return reverse_iterator{end()};
+    }
+    
+    REGULUS_CONSTEXPR20 const_reverse_iterator rbegin(void) const
+    {
+      return const_reverse_iterator{end()};
+    }
+    
+    REGULUS_CONSTEXPR20 const_reverse_iterator crbegin(void) const
+    {
+      return const_reverse_iterator{end()};
+    }
+    
+    REGULUS_CONSTEXPR20 reverse_iterator rend(void)
+    {
+      return reverse_iterator{begin()};
+    }
+    
+    REGULUS_CONSTEXPR20 const_reverse_iterator rend(void) const
+    {
+      return const_reverse_iterator{begin()};
+    }
+    
+    REGULUS_CONSTEXPR20 const_reverse_iterator crend(void) const
+    {
+      return const_reverse_iterator{begin()};
     }
     
     // Capacity
-    size_type size(void) const
+    REGULUS_CONSTEXPR20 size_type size(void) const
     {
       return size_;
     }
     
-    size_type capacity(void) const
+    REGULUS_CONSTEXPR20 size_type capacity(void) const
     {
       return N;
     }
     
     // Modifiers
-    iterator insert(iterator it, const_reference val)
+    REGULUS_CONSTEXPR20 iterator insert(const_iterator it, const_reference val)
     {
-      auto pos = it.pos_;
-      
-      auto first = address_at(size_ - 1);
-      auto last = address_at(pos);
+      auto const first = address_at(it - cbegin());
+      auto const last = address_at(size_);
       
-      // move all elements to the right by 1
-      for (auto ptr = first; ptr >= last; --ptr) {
-        new(ptr + 1) value_type{std::move(*ptr)};
+      // val may refer to an element we're about to shift
+      const_pointer src = std::addressof(val);
+      if (detail::points_into<T>(src, first, last)) {
+        ++src;
       }
       
+      // open up a hole by relocating everything to the right by 1
+      detail::relocate(first, last, first + 1);
+      
       // construct element in-place
-      new(last) value_type{val};
+      detail::construct_at(first, *src);
       ++size_;
       
       // return iterator to the new element
-      return iterator{*this, pos};
+      return first;
     }
     
-    iterator erase(iterator it)
+    template <typename ...Args>
+    REGULUS_CONSTEXPR20 iterator emplace(const_iterator it, Args&& ...args)
     {
-      auto pos = it.pos_;
-      it->~value_type();
+      auto const first = address_at(it - cbegin());
+      auto const last = address_at(size_);
+      
+      if (first == last) {
+        emplace_back(std::forward<Args>(args)...);
+        return first;
+      }
       
-      auto begin = address_at(pos + 1);
-      auto end = address_at(size_);
+      // the arguments may refer to an element we're about to shift
+      // so the new element gets built before anything moves
+      value_type tmp{std::forward<Args>(args)...};
+      detail::relocate(first, last, first + 1);
+      detail::construct_at(first, std::move(tmp));
+      ++size_;
       
-      for (auto ptr= begin; ptr < end; ++ptr) {
-        new(ptr - 1) value_type{std::move(*ptr)};
+      return first;
+    }
+    
+    REGULUS_CONSTEXPR20 iterator insert(const_iterator it, size_type const count, const_reference val)
+    {
+      check_capacity(count);
+      
+      auto const first = address_at(it - cbegin());
+      auto const last = address_at(size_);
+      
+      const_pointer src = std::addressof(val);
+      if (detail::points_into<T>(src, first, last)) {
+        src += count;
       }
-
+      
+      detail::relocate(first, last, first + count);
+      try {
+        detail::uninitialized_fill(first, first + count, *src);
+      } catch (...) {
+        detail::relocate(first + count, last + count, first);
+        throw;
+      }
+      
+      size_ += count;
+      return first;
+    }
+    
+    template <
+      typename InputIt,
+      typename = typename std::iterator_traits<InputIt>::iterator_category
+    >
+    REGULUS_CONSTEXPR20 iterator insert(const_iterator it, InputIt first, InputIt last)
+    {
+      return insert_range(
+        it, first, last,
+        typename std::iterator_traits<InputIt>::iterator_category{});
+    }
+    
+    REGULUS_CONSTEXPR20 iterator insert(const_iterator it, std::initializer_list<value_type> init)
+    {
+      return insert(it, init.begin(), init.end());
+    }
+    
+    template <typename Range>
+    REGULUS_CONSTEXPR20 void append_range(Range&& range)
+    {
+      using std::begin;
+      using std::end;
+      insert(cend(), begin(range), end(range));
+    }
+    
+    template <
+      typename InputIt,
+      typename = typename std::iterator_traits<InputIt>::iterator_category
+    >
+    REGULUS_CONSTEXPR20 void assign(InputIt first, InputIt last)
+    {
+      clear();
+      insert(cend(), first, last);
+    }
+    
+    REGULUS_CONSTEXPR20 void assign(std::initializer_list<value_type> init)
+    {
+      assign(init.begin(), init.end());
+    }
+    
+    REGULUS_CONSTEXPR20 void clear(void)
+    {
+      auto const ptr = address_at(0);
+      for (size_type i = 0; i < size_; ++i) {
+        detail::destroy_at(ptr + i);
+      }
+      size_ = 0;
+    }
+    
+    REGULUS_CONSTEXPR20 iterator erase(const_iterator it)
+    {
+      auto const pos = address_at(it - cbegin());
+      detail::destroy_at(pos);
+      
+      // close the gap in a single relocation
+      detail::relocate(pos + 1, end(), pos);
+      
       --size_;
-      return iterator{*this, pos};
+      return pos;
+    }
+    
+    REGULUS_CONSTEXPR20 iterator erase(const_iterator first, const_iterator last)
+    {
+      auto const pos = address_at(first - cbegin());
+      auto const count = static_cast<size_type>(last - first);
+      for (auto ptr = pos; ptr != pos + count; ++ptr) {
+        detail::destroy_at(ptr);
+      }
+      
+      detail::relocate(pos + count, end(), pos);
+      
+      size_ -= count;
+      return pos;
+    }
+    
+    /**
+      * Erases it by moving the last element into its place instead of
+      * shifting everything behind it, so the order isn't kept.
+      */
+    REGULUS_CONSTEXPR20 iterator erase_unordered(const_iterator it)
+    {
+      auto const pos = address_at(it - cbegin());
+      auto const last = address_at(size_ - 1);
+      detail::destroy_at(pos);
+      
+      if (pos != last) {
+        detail::relocate(last, last + 1, pos);
+      }
+      
+      --size_;
+      return pos;
+    }
+    
+    /**
+      * Erases every element pred returns true for in a single pass and
+      * returns how many there were.
+      */
+    template <typename Pred>
+    REGULUS_CONSTEXPR20 size_type erase_if(Pred pred)
+    {
+      auto const kept = compact(
+        pred, std::integral_constant<bool, std::is_arithmetic<T>::value>{});
+      auto const erased = size_ - kept;
+      truncate(kept);
+      return erased;
     }
     
     template <typename ...Args>
-    void emplace_back(Args&& ...args)
+    REGULUS_CONSTEXPR20 void emplace_back(Args&& ...args)
     {
-      new(address_at(size_)) value_type{std::forward<Args>(args)...};
+      detail::construct_at(address_at(size_), std::forward<Args>(args)...);
       ++size_;
     }
     
-    void pop_back(void)
+    REGULUS_CONSTEXPR20 void pop_back(void)
     {
-      caddress_at(size_ - 1)->~value_type();
+      detail::destroy_at(caddress_at(size_ - 1));
       --size_;
     }
     
-    void resize(size_type const count)
+    REGULUS_CONSTEXPR20 void resize(size_type const count)
     {
-      for (size_type i = size_; i < count; ++i) {
-        this->emplace_back();        
+      if (count <= size_) {
+        truncate(count);
+        return;
       }
+      
+      check_capacity(count - size_);
+      
+      auto const first = address_at(size_);
+      auto const last = address_at(count);
+      auto ptr = first;
+      try {
+        for (; ptr != last; ++ptr) {
+          detail::construct_at(ptr);
+        }
+      } catch (...) {
+        while (ptr != first) {
+          detail::destroy_at(--ptr);
+        }
+        throw;
+      }
+      size_ = count;
     }
     
-    static_vector slice(size_type const pos)
+    REGULUS_CONSTEXPR20 void resize(size_type const count, const_reference val)
     {
-      static_vector dst;
-      for (size_type i = pos; i < size_; ++i) {
-        dst.emplace_back(std::move(*address_at(i)));
+      if (count <= size_) {
+        resize(count);
+        return;
       }
-      size_ = pos;
+      insert(cend(), count - size_, val);
+    }
+    
+    REGULUS_CONSTEXPR20 static_vector slice(size_type const pos)
+    {
+      static_vector dst;
+      dst.splice(*this, pos);
       return dst;
     }
+    
+    /**
+      * Swaps the elements both vectors have and relocates the rest of
+      * the longer one over in a single go.
+      */
+    REGULUS_CONSTEXPR20 void swap(static_vector& other)
+      noexcept(nothrow_move && std::is_nothrow_move_assignable<T>::value)
+    {
+      auto shorter = this;
+      auto longer = std::addressof(other);
+      if (shorter->size_ > longer->size_) {
+        std::swap(shorter, longer);
+      }
+      
+      auto const common = shorter->size_;
+      std::swap_ranges(shorter->begin(), shorter->end(), longer->begin());
+      detail::relocate(
+        longer->begin() + common, longer->end(), shorter->begin() + common);
+      
+      std::swap(size_, other.size_);
+    }
+    
+    REGULUS_CONSTEXPR20 void splice(static_vector& other, size_type const pos)
+    {
+      auto const count = other.size_ - pos;
+      check_capacity(count);
+      
+      detail::relocate(other.address_at(pos), other.end(), end());
+      size_ += count;
+      other.size_ = pos;
+    }
+    
+    // moves the first count elements of other to the end of this one,
+    // other's remaining elements get shifted down in a single relocation
+    REGULUS_CONSTEXPR20 void splice_front(static_vector& other, size_type const count)
+    {
+      check_capacity(count);
+      
+      auto const first = other.address_at(0);
+      detail::relocate(first, first + count, end());
+      detail::relocate(first + count, other.end(), first);
+      size_ += count;
+      other.size_ -= count;
+    }
   };
+  
+  template <typename T, std::size_t N>
+  REGULUS_CONSTEXPR20 void swap(static_vector<T, N>& a, static_vector<T, N>& b) noexcept(noexcept(a.swap(b)))
+  {
+    a.swap(b);
+  }
 }
 
 #endif // REGULUS_STATIC_VECTOR_HPP_
\ No newline at end of file
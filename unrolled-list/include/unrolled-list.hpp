@@ -1,11 +1,206 @@
 #ifndef REGULUS_UNROLLED_LIST_HPP_
 #define REGULUS_UNROLLED_LIST_HPP_
 
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include <type_traits>
+
 #include "static-vector.hpp"
+#include "pool-allocator.hpp"
+#include "fenwick-tree.hpp"
+
+/**
+  * How many nodes ahead of the one we just hopped into iteration
+  * prefetches. 0 turns prefetching off. A split policy can override
+  * it per list with a `prefetch_distance` member.
+  */
+#ifndef REGULUS_PREFETCH_DISTANCE
+#define REGULUS_PREFETCH_DISTANCE 1
+#endif
 
 namespace regulus
 {
+  namespace detail
+  {
+    inline void prefetch(void const* ptr)
+    {
+#if defined(__GNUC__)
+      __builtin_prefetch(ptr, 0, 3);
+#else
+      (void) ptr;
+#endif
+    }
+    
+    template <typename Policy, typename = void>
+    struct prefetch_distance
+      : std::integral_constant<std::size_t, REGULUS_PREFETCH_DISTANCE>
+    {};
+    
+    template <typename Policy>
+    struct prefetch_distance<
+      Policy, decltype((void) Policy::prefetch_distance)>
+      : std::integral_constant<std::size_t, Policy::prefetch_distance>
+    {};
+    
+    template <typename...>
+    struct make_void
+    {
+      typedef void type;
+    };
+  }
+  
+  /**
+    * A summary lives in the header of every node and describes the
+    * elements stored in it. It sees every element that gets added to
+    * its node and is rebuilt from the node's elements whenever any of
+    * them leave. no_summary keeps nothing and costs nothing.
+    */
   template <typename T>
+  struct no_summary
+  {
+    void add(T const&)
+    {}
+    
+    template <typename It>
+    void assign(It, It)
+    {}
+  };
+  
+  // smallest and largest element of a node according to operator<
+  template <typename T>
+  struct minmax_summary
+  {
+    T    min;
+    T    max;
+    bool empty;
+    
+    minmax_summary(void)
+      : min{}
+      , max{}
+      , empty{true}
+    {}
+    
+    void add(T const& val)
+    {
+      if (empty) {
+        min = val;
+        max = val;
+        empty = false;
+        return;
+      }
+      
+      if (val < min) {
+        min = val;
+      }
+      if (max < val) {
+        max = val;
+      }
+    }
+    
+    template <typename It>
+    void assign(It first, It last)
+    {
+      empty = true;
+      for (; first != last; ++first) {
+        add(*first);
+      }
+    }
+  };
+  
+  namespace detail
+  {
+    template <typename Policy, typename T, typename = void>
+    struct summary_of
+    {
+      typedef no_summary<T> type;
+    };
+    
+    template <typename Policy, typename T>
+    struct summary_of<
+      Policy, T,
+      typename make_void<typename Policy::template summary<T>>::type>
+    {
+      typedef typename Policy::template summary<T> type;
+    };
+  }
+  
+  /**
+    * By default a node gets as many elements as fit in CacheLines
+    * cache lines (but always at least 2 so it can be split).
+    */
+  template <typename T, std::size_t CacheLines = 4>
+  struct default_node_size
+    : std::integral_constant<
+        std::size_t,
+        (CacheLines * 64 / sizeof(T) > 2 ? CacheLines * 64 / sizeof(T) : 2)>
+  {};
+  
+  /**
+    * Split policies decide how many elements stay behind when a
+    * full node gets split in two, and how empty two neighbouring
+    * nodes have to get before erase() merges them back together.
+    *
+    * fill_split_policy lets emplace_back() leave the full tail alone
+    * and start an empty node so appending packs every node completely.
+    * Inserting into the middle of a full node still splits it in half
+    * so both halves have room to grow.
+    *
+    * A policy may also define `static constexpr std::size_t
+    * prefetch_distance` to override REGULUS_PREFETCH_DISTANCE and
+    * a `template <typename T> using summary = ...;` to keep a summary
+    * (see no_summary) in every node.
+    */
+  struct fill_split_policy
+  {
+    static constexpr std::size_t append_split(std::size_t const capacity)
+    {
+      return capacity;
+    }
+    
+    static constexpr std::size_t insert_split(std::size_t const capacity)
+    {
+      return capacity / 2;
+    }
+    
+    // staying well below the split point keeps a node that was just
+    // split from being merged right back on the next erase
+    static constexpr std::size_t merge_threshold(std::size_t const capacity)
+    {
+      return capacity / 4;
+    }
+  };
+  
+  /**
+    * Always split in half, even when appending. Leaves room in every
+    * node which suits lists that see a lot of inserts all over the place.
+    */
+  struct half_split_policy
+  {
+    static constexpr std::size_t append_split(std::size_t const capacity)
+    {
+      return capacity / 2;
+    }
+    
+    static constexpr std::size_t insert_split(std::size_t const capacity)
+    {
+      return capacity / 2;
+    }
+    
+    static constexpr std::size_t merge_threshold(std::size_t const capacity)
+    {
+      return capacity / 4;
+    }
+  };
+  
+  template <
+    typename T,
+    std::size_t NodeSize = default_node_size<T>::value,
+    typename SplitPolicy = fill_split_policy,
+    typename Allocator = std::allocator<T>
+  >
   class unrolled_list
   {
   public:
@@ -14,40 +209,111 @@ namespace regulus
     typedef std::ptrdiff_t    difference_type;
     typedef value_type&       reference;
     typedef value_type const& const_reference;
-    typedef size_type*        pointer;
-    typedef size_type const*  const_pointer;
+    typedef value_type*       pointer;
+    typedef value_type const* const_pointer;
+    typedef Allocator         allocator_type;
     
-    std::size_t const static node_size = 32;
+    typedef typename detail::summary_of<SplitPolicy, T>::type summary_type;
     
+    std::size_t const static node_size = NodeSize;
+    std::size_t const static prefetch_distance =
+      detail::prefetch_distance<SplitPolicy>::value;
+    
+    static_assert(node_size >= 2, "Nodes need room for at least 2 elements");
+    static_assert(
+      SplitPolicy::insert_split(node_size) > 0 &&
+      SplitPolicy::insert_split(node_size) < node_size,
+      "Splitting a full node has to leave elements in both halves");
+  
   private:
-    struct node
+    /**
+      * The header goes first: the summary (empty ones take no room),
+      * the links and the index, directly followed by the element
+      * count at the front of vec. Walking the chain without looking
+      * at the elements only ever touches the node's first cache line.
+      */
+    struct node : summary_type
     {
     public:
-      static_vector<T, node_size> vec;
       node* next;
       node* prev;
       
+      // position in the node index, only valid while it's up to date
+      size_type index;
+      
+      static_vector<T, node_size> vec;
+    
     public:
       node(void)
         : next{nullptr}
         , prev{nullptr}
+        , index{0}
       {}
+      
+      summary_type const& summary(void) const
+      {
+        return *this;
+      }
+      
+      // brings the summary back in line after elements left the node
+      void summarize(void)
+      {
+        summary_type::assign(vec.begin(), vec.end());
+      }
     };
     
+    // nodes are what actually gets allocated so we rebind to them
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<node>
+      node_allocator;
+    typedef std::allocator_traits<node_allocator> node_traits;
+    
+    // roughly where vec's elements start, enough for prefetching
+    std::size_t const static header_size =
+      sizeof(summary_type) + 2 * sizeof(node*) + 2 * sizeof(size_type);
+    
+    /**
+      * Called whenever iteration hops into curr. Hopping nodes is a
+      * pointer chase that misses the cache once nodes are scattered
+      * over the heap, so we get the node prefetch_distance hops ahead
+      * on its way while we're busy with this one. The links in between
+      * were prefetched on earlier hops so following them is cheap.
+      */
+    static void prefetch_ahead(
+      node const* curr, std::size_t const bytes = sizeof(node))
+    {
+      if (prefetch_distance == 0) {
+        return;
+      }
+      
+      auto ahead = curr->next;
+      for (std::size_t i = 1; i < prefetch_distance && ahead != nullptr; ++i) {
+        ahead = ahead->next;
+      }
+      
+      if (ahead != nullptr) {
+        auto const first = reinterpret_cast<char const*>(ahead);
+        for (std::size_t i = 0; i < bytes; i += detail::cache_line_size) {
+          detail::prefetch(first + i);
+        }
+      }
+    }
+  
   public:
     class iterator :
       public std::iterator<std::bidirectional_iterator_tag, value_type>
     {
     private:
+      friend class unrolled_list;
+      
       node* curr_node_;
       difference_type pos_;
-      
+    
     public:
       iterator(node* curr_node, difference_type pos)
         : curr_node_{curr_node}
         , pos_{pos}
       {}
-            
+      
       reference operator*(void)
       {
         return curr_node_->vec[pos_];
@@ -74,6 +340,7 @@ namespace regulus
             // breaks program flow
             curr_node_ = next;
             pos_ = 0;
+            prefetch_ahead(next);
             return *this;
           }
         }
@@ -101,16 +368,204 @@ namespace regulus
       }
     };
     
+    /**
+      * A segment is the contiguous run of elements stored in a
+      * single node. Algorithms that work segment by segment get
+      * a plain [first, last) pointer range for their inner loop
+      * and only pay for hopping nodes once per segment.
+      */
+    template <typename Pointer>
+    class basic_segment
+    {
+    private:
+      friend class unrolled_list;
+      
+      node* node_;
+    
+    public:
+      explicit basic_segment(node* curr)
+        : node_{curr}
+      {}
+      
+      Pointer begin(void) const
+      {
+        return node_->vec.data();
+      }
+      
+      Pointer end(void) const
+      {
+        return node_->vec.data() + node_->vec.size();
+      }
+      
+      size_type size(void) const
+      {
+        return node_->vec.size();
+      }
+      
+      summary_type const& summary(void) const
+      {
+        return node_->summary();
+      }
+      
+      // rebuilds the summary after writing through the segment's pointers
+      void summarize(void) const
+      {
+        node_->summarize();
+      }
+    };
+    
+    typedef basic_segment<pointer>       segment;
+    typedef basic_segment<const_pointer> const_segment;
+    
+    template <typename Segment>
+    class basic_segment_iterator :
+      public std::iterator<
+        std::forward_iterator_tag, Segment,
+        difference_type, Segment const*, Segment>
+    {
+    private:
+      node* curr_node_;
+    
+    public:
+      explicit basic_segment_iterator(node* curr)
+        : curr_node_{curr}
+      {}
+      
+      Segment operator*(void) const
+      {
+        return Segment{curr_node_};
+      }
+      
+      bool operator==(basic_segment_iterator const& other) const
+      {
+        return curr_node_ == other.curr_node_;
+      }
+      
+      bool operator!=(basic_segment_iterator const& other) const
+      {
+        return !(*this == other);
+      }
+      
+      basic_segment_iterator& operator++(void)
+      {
+        curr_node_ = curr_node_->next;
+        if (curr_node_ != nullptr) {
+          prefetch_ahead(curr_node_);
+        }
+        return *this;
+      }
+      
+      basic_segment_iterator operator++(int)
+      {
+        auto tmp = *this;
+        ++(*this);
+        return tmp;
+      }
+    };
+    
+    template <typename Segment>
+    class basic_segment_range
+    {
+    private:
+      node* head_;
+    
+    public:
+      typedef basic_segment_iterator<Segment> iterator;
+      
+      explicit basic_segment_range(node* head)
+        : head_{head}
+      {}
+      
+      iterator begin(void) const
+      {
+        return iterator{head_};
+      }
+      
+      iterator end(void) const
+      {
+        return iterator{nullptr};
+      }
+    };
+    
+    typedef basic_segment_range<segment>       segment_range;
+    typedef basic_segment_range<const_segment> const_segment_range;
+  
   private:
+    node_allocator alloc_;
     node *head_;
     node *tail_;
     size_type size_;
+    size_type node_count_;
+    
+    // empty nodes set aside by reserve() and assign(), linked through next
+    node* spare_;
+    size_type spare_count_;
     
+    // where the next compact() call picks up, null to start at the head
+    node* compact_from_;
+    
+    /**
+      * Order-statistics index over the nodes. It's built lazily by
+      * the first indexed lookup and kept up to date from then on.
+      * The tail's count isn't part of the tree (it's whatever's left
+      * of size_) so appending doesn't cost anything extra and changes
+      * to other nodes are an O(log n) update. Splitting or removing a
+      * node anywhere but the end renumbers and rebuilds the nodes after
+      * it, so the worst case, inserting at the front, is O(n / node_size)
+      * per split. Bulk operations that move many nodes around drop the
+      * index instead and leave it to the next lookup.
+      */
+    mutable std::vector<node*>   nodes_;
+    mutable detail::fenwick_tree counts_;
+    mutable size_type            indexed_size_;
+    mutable bool                 index_dirty_;
+  
   private:
+    node* create_node(void)
+    {
+      auto ptr = node_traits::allocate(alloc_, 1);
+      try {
+        node_traits::construct(alloc_, ptr);
+      } catch (...) {
+        node_traits::deallocate(alloc_, ptr, 1);
+        throw;
+      }
+      return ptr;
+    }
+    
+    void destroy_node(node* ptr)
+    {
+      node_traits::destroy(alloc_, ptr);
+      node_traits::deallocate(alloc_, ptr, 1);
+    }
+    
+    // a spare node if there is one, a new one otherwise
+    node* take_node(void)
+    {
+      if (spare_ == nullptr) {
+        return create_node();
+      }
+      
+      auto ptr = spare_;
+      spare_ = ptr->next;
+      --spare_count_;
+      
+      ptr->next = nullptr;
+      return ptr;
+    }
+    
+    void add_spare(node* ptr)
+    {
+      ptr->prev = nullptr;
+      ptr->next = spare_;
+      spare_ = ptr;
+      ++spare_count_;
+    }
+    
     node* insert_node(node& curr)
     {
       auto next = curr.next;
-      auto new_node = new node;
+      auto new_node = take_node();
       
       curr.next = new_node;
       new_node->prev = std::addressof(curr);
@@ -122,25 +577,301 @@ namespace regulus
         next->prev = new_node;
       }
       
+      ++node_count_;
+      return new_node;
+    }
+    
+    void ensure_index(void) const
+    {
+      if (!index_dirty_) {
+        return;
+      }
+      
+      // a single walk over the node headers, the tail's count
+      // isn't part of the tree
+      nodes_.clear();
+      auto curr = head_;
+      counts_.assign(
+        node_count_ - 1,
+        [this, &curr](size_type const i)
+        {
+          curr->index = i;
+          nodes_.push_back(curr);
+          
+          auto const count = curr->vec.size();
+          curr = curr->next;
+          return count;
+        });
+      
+      tail_->index = nodes_.size();
+      nodes_.push_back(tail_);
+      
+      indexed_size_ = size_ - tail_->vec.size();
+      index_dirty_ = false;
+    }
+    
+    // the number of elements in curr changed by delta
+    void index_resized(node* curr, difference_type const delta)
+    {
+      if (!index_dirty_ && curr != tail_) {
+        counts_.add(curr->index, delta);
+        indexed_size_ += delta;
+      }
+    }
+    
+    // old_tail just got a new tail node after it
+    void index_appended(node* old_tail)
+    {
+      if (!index_dirty_) {
+        counts_.push_back(old_tail->vec.size());
+        indexed_size_ += old_tail->vec.size();
+        tail_->index = nodes_.size();
+        nodes_.push_back(tail_);
+      }
+    }
+    
+    // nodes_ changed from pos on, renumbers those nodes and rebuilds
+    // their part of the tree
+    void reindex_from(size_type const pos)
+    {
+      counts_.assign_from(
+        pos, nodes_.size() - 1,
+        [this](size_type const i)
+        {
+          nodes_[i]->index = i;
+          return nodes_[i]->vec.size();
+        });
+      tail_->index = nodes_.size() - 1;
+    }
+    
+    // new_node just got linked in after curr, neither is the tail
+    void index_inserted(node* curr, node* new_node)
+    {
+      if (!index_dirty_) {
+        auto const pos = curr->index;
+        nodes_.insert(nodes_.begin() + pos + 1, new_node);
+        reindex_from(pos);
+      }
+    }
+    
+    // curr is about to be removed from the list
+    void index_removed(node* curr)
+    {
+      if (index_dirty_) {
+        return;
+      }
+      
+      if (curr != tail_) {
+        auto const pos = curr->index;
+        indexed_size_ -= curr->vec.size();
+        nodes_.erase(nodes_.begin() + pos);
+        reindex_from(pos);
+        return;
+      }
+      
+      if (curr->prev == nullptr) {
+        index_dirty_ = true;
+        return;
+      }
+      
+      // the node before the tail takes over as the implicit count
+      counts_.pop_back();
+      indexed_size_ -= curr->prev->vec.size();
+      nodes_.pop_back();
+    }
+    
+    // unlinks an empty node and gives it back to the allocator
+    void remove_node(node* curr)
+    {
+      index_removed(curr);
+      if (curr == compact_from_) {
+        compact_from_ = nullptr;
+      }
+      
+      auto prev = curr->prev;
+      auto next = curr->next;
+      
+      if (prev) {
+        prev->next = next;
+      } else {
+        head_ = next;
+      }
+      
+      if (next) {
+        next->prev = prev;
+      } else {
+        tail_ = prev;
+      }
+      
+      destroy_node(curr);
+      --node_count_;
+    }
+    
+    // moves the upper part of a full node into a new node after it
+    node* split_node(node& curr)
+    {
+      auto new_node = insert_node(curr);
+      new_node->vec.splice(curr.vec, SplitPolicy::insert_split(node_size));
+      curr.summarize();
+      new_node->summarize();
+      
+      if (tail_ == std::addressof(curr)) {
+        tail_ = new_node;
+        index_appended(std::addressof(curr));
+      } else {
+        index_inserted(std::addressof(curr), new_node);
+      }
+      
       return new_node;
     }
     
+    // leaves just the (emptied) head behind
+    void reset_head(void)
+    {
+      head_->vec.clear();
+      head_->summarize();
+      head_->next = nullptr;
+      tail_ = head_;
+      size_ = 0;
+      node_count_ = 1;
+      index_dirty_ = true;
+      compact_from_ = nullptr;
+    }
+    
+    /**
+      * Appending a range of known length fills the tail and then
+      * whole nodes in one go, each with a single bulk copy (a memcpy
+      * for trivially copyable T). Every node but the last one ends
+      * up full no matter what the split policy says.
+      */
+    template <typename ForwardIt>
+    void append_from(ForwardIt first, ForwardIt last, std::forward_iterator_tag)
+    {
+      auto count = static_cast<size_type>(std::distance(first, last));
+      reserve(size_ + count);
+      
+      while (count > 0) {
+        if (tail_->vec.size() == node_size) {
+          auto old_tail = tail_;
+          tail_ = insert_node(*old_tail);
+          index_appended(old_tail);
+        }
+        
+        auto const chunk = std::min(count, node_size - tail_->vec.size());
+        auto const mid = std::next(first, chunk);
+        auto const added = tail_->vec.insert(tail_->vec.end(), first, mid);
+        for (auto ptr = added; ptr != tail_->vec.end(); ++ptr) {
+          tail_->add(*ptr);
+        }
+        
+        size_ += chunk;
+        count -= chunk;
+        first = mid;
+      }
+    }
+    
+    template <typename InputIt>
+    void append_from(InputIt first, InputIt last, std::input_iterator_tag)
+    {
+      for (; first != last; ++first) {
+        emplace_back(*first);
+      }
+    }
+    
+    /**
+      * Tops curr up with elements from the front of the nodes after
+      * it, the nodes that get emptied are released. Whatever's left
+      * in a node gets shifted down once, so no element is moved more
+      * than twice over a whole pass.
+      */
+    void fill_node(node* curr)
+    {
+      // emptied nodes get removed on the way, rebuilding the index
+      // once afterwards beats patching it for every one of them
+      if (curr->vec.size() < node_size && curr->next != nullptr) {
+        index_dirty_ = true;
+      }
+      
+      auto const old_size = curr->vec.size();
+      while (curr->vec.size() < node_size && curr->next != nullptr) {
+        auto next = curr->next;
+        auto const count = std::min(node_size - curr->vec.size(), next->vec.size());
+        
+        // a memmove each way for trivially relocatable T
+        curr->vec.splice_front(next->vec, count);
+        
+        if (next->vec.size() == 0) {
+          remove_node(next);
+        } else {
+          next->summarize();
+        }
+      }
+      
+      if (curr->vec.size() != old_size) {
+        curr->summarize();
+      }
+    }
+    
+    // only the end() iterator is allowed to sit one past the last
+    // element of a node
+    iterator make_iterator(node* curr, difference_type const pos) const
+    {
+      if (pos == (difference_type ) curr->vec.size() && curr->next != nullptr) {
+        return iterator{curr->next, 0};
+      }
+      return iterator{curr, pos};
+    }
+  
   public:
     unrolled_list(void)
-      : head_{new node}
+      : unrolled_list(Allocator{})
+    {}
+    
+    explicit unrolled_list(Allocator const& alloc)
+      : alloc_{alloc}
+      , head_{create_node()}
       , tail_{head_}
       , size_{0}
+      , node_count_{1}
+      , spare_{nullptr}
+      , spare_count_{0}
+      , compact_from_{nullptr}
+      , indexed_size_{0}
+      , index_dirty_{true}
     {}
     
+    template <
+      typename InputIt,
+      typename = typename std::iterator_traits<InputIt>::iterator_category
+    >
+    unrolled_list(InputIt first, InputIt last, Allocator const& alloc = Allocator{})
+      : unrolled_list(alloc)
+    {
+      append_from(
+        first, last,
+        typename std::iterator_traits<InputIt>::iterator_category{});
+    }
+    
     ~unrolled_list(void)
     {
       while (head_ != nullptr) {
         auto tmp = head_;
         head_ = head_->next;
-        delete tmp;
+        destroy_node(tmp);
+      }
+      
+      while (spare_ != nullptr) {
+        auto tmp = spare_;
+        spare_ = spare_->next;
+        destroy_node(tmp);
       }
     }
-            
+    
+    allocator_type get_allocator(void) const
+    {
+      return allocator_type{alloc_};
+    }
+    
     // Iterators
     iterator begin(void) const
     {
@@ -152,24 +883,498 @@ namespace regulus
       return iterator{tail_, (difference_type ) tail_->vec.size()};
     }
     
+    // Segments
+    segment_range segments(void)
+    {
+      return segment_range{head_};
+    }
+    
+    const_segment_range segments(void) const
+    {
+      return const_segment_range{head_};
+    }
+    
+    // calls f(first, last) with the pointer range of every node,
+    // f may write to the elements
+    template <typename F>
+    void for_each_segment(F f)
+    {
+      for (auto curr = head_; curr != nullptr; curr = curr->next) {
+        prefetch_ahead(curr);
+        f(curr->vec.begin(), curr->vec.end());
+        curr->summarize();
+      }
+    }
+    
+    template <typename F>
+    void for_each_segment(F f) const
+    {
+      for (node const* curr = head_; curr != nullptr; curr = curr->next) {
+        prefetch_ahead(curr);
+        f(curr->vec.begin(), curr->vec.end());
+      }
+    }
+    
+    /**
+      * Calls f(seg) for every segment until it returns false. Only
+      * the headers of the nodes ahead get prefetched, so a scan that
+      * skips most nodes by looking at their summary doesn't pull in
+      * elements it never reads.
+      */
+    template <typename F>
+    void scan_segments(F f) const
+    {
+      for (auto curr = head_; curr != nullptr; curr = curr->next) {
+        prefetch_ahead(curr, header_size);
+        if (!f(const_segment{curr})) {
+          return;
+        }
+      }
+    }
+    
+    // turns a pointer into a segment back into a list iterator
+    template <typename Pointer>
+    iterator to_iterator(basic_segment<Pointer> const& seg, Pointer ptr) const
+    {
+      return make_iterator(seg.node_, ptr - seg.begin());
+    }
+    
+    // Element Access
+    reference front(void)
+    {
+      return head_->vec.front();
+    }
+    
+    const_reference front(void) const
+    {
+      return head_->vec.front();
+    }
+    
+    reference back(void)
+    {
+      return tail_->vec.back();
+    }
+    
+    const_reference back(void) const
+    {
+      return tail_->vec.back();
+    }
+    
+    /**
+      * Indexed access goes through the node index and costs
+      * O(log n), plus O(n / node_size) to rebuild the index the
+      * first time around or after nodes got added to or removed
+      * from the middle of the list.
+      */
+    reference at(size_type const pos)
+    {
+      if (pos >= size_) {
+        throw std::out_of_range{"Index is out of bounds!"};
+      }
+      return this->operator[](pos);
+    }
+    
+    const_reference at(size_type const pos) const
+    {
+      if (pos >= size_) {
+        throw std::out_of_range{"Index is out of bounds!"};
+      }
+      return this->operator[](pos);
+    }
+    
+    reference operator[](size_type const pos)
+    {
+      auto it = iterator_at(pos);
+      return it.curr_node_->vec[it.pos_];
+    }
+    
+    const_reference operator[](size_type const pos) const
+    {
+      auto it = iterator_at(pos);
+      return it.curr_node_->vec[it.pos_];
+    }
+    
+    iterator iterator_at(size_type const pos) const
+    {
+      if (pos >= size_) {
+        return end();
+      }
+      
+      ensure_index();
+      if (pos >= indexed_size_) {
+        return iterator{tail_, (difference_type ) (pos - indexed_size_)};
+      }
+      
+      size_type offset = 0;
+      auto const idx = counts_.find(pos, offset);
+      return iterator{nodes_[idx], (difference_type ) offset};
+    }
+    
+    size_type index_of(iterator it) const
+    {
+      ensure_index();
+      if (it.curr_node_ == tail_) {
+        return indexed_size_ + it.pos_;
+      }
+      return counts_.prefix(it.curr_node_->index) + it.pos_;
+    }
+    
     // Capacity
     size_type size(void) const
     {
       return size_;
     }
     
+    size_type node_count(void) const
+    {
+      return node_count_;
+    }
+    
+    // element slots in every node, the spare ones included
+    size_type capacity(void) const
+    {
+      return (node_count_ + spare_count_) * node_size;
+    }
+    
+    /**
+      * Sets aside exactly as many empty nodes as it takes to append
+      * up to count elements in total without allocating. Appending
+      * ranges fills nodes completely so they'll use every slot;
+      * emplace_back() does too unless the split policy says otherwise.
+      */
+    void reserve(size_type const count)
+    {
+      auto const room = (node_size - tail_->vec.size()) + spare_count_ * node_size;
+      if (count <= size_ + room) {
+        return;
+      }
+      
+      auto const nodes = (count - size_ - room + node_size - 1) / node_size;
+      for (size_type i = 0; i < nodes; ++i) {
+        add_spare(create_node());
+      }
+    }
+    
     // Modifiers
+    /**
+      * Calls f(*it) and brings the node's summary back in line.
+      * Writing through iterators or operator[] directly leaves
+      * summaries out of date.
+      */
+    template <typename F>
+    void modify(iterator it, F f)
+    {
+      f(*it);
+      it.curr_node_->summarize();
+    }
+    
     template <typename ...Args>
     void emplace_back(Args&& ...args)
     {
       if (tail_->vec.size() == tail_->vec.capacity()) {
         auto old_tail = tail_;
         tail_ = insert_node(*old_tail);
-        tail_->vec = std::move(old_tail->vec.slice(node_size / 2));
+        tail_->vec.splice(old_tail->vec, SplitPolicy::append_split(node_size));
+        if (SplitPolicy::append_split(node_size) < node_size) {
+          old_tail->summarize();
+          tail_->summarize();
+        }
+        index_appended(old_tail);
       }
       
       tail_->vec.emplace_back(std::forward<Args>(args)...);
+      tail_->add(tail_->vec.back());
+      ++size_;
+    }
+    
+    template <typename ...Args>
+    void emplace_front(Args&& ...args)
+    {
+      emplace(begin(), std::forward<Args>(args)...);
+    }
+    
+    /**
+      * Construct an element in front of it. Only the node it points
+      * into gets touched unless that node is full, in which case
+      * the element goes to the end of the previous node if there's
+      * room or the node gets split according to the split policy.
+      */
+    template <typename ...Args>
+    iterator emplace(iterator it, Args&& ...args)
+    {
+      auto curr = it.curr_node_;
+      auto pos = it.pos_;
+      
+      if (curr->vec.size() < node_size) {
+        curr->vec.emplace(curr->vec.begin() + pos, std::forward<Args>(args)...);
+        curr->add(curr->vec[pos]);
+        index_resized(curr, 1);
+        ++size_;
+        return iterator{curr, pos};
+      }
+      
+      if (pos == 0 && curr->prev != nullptr && curr->prev->vec.size() < node_size) {
+        curr = curr->prev;
+        curr->vec.emplace_back(std::forward<Args>(args)...);
+        curr->add(curr->vec.back());
+        index_resized(curr, 1);
+        ++size_;
+        return iterator{curr, (difference_type ) curr->vec.size() - 1};
+      }
+      
+      if (curr == tail_ && pos == (difference_type ) curr->vec.size()) {
+        emplace_back(std::forward<Args>(args)...);
+        return iterator{tail_, (difference_type ) tail_->vec.size() - 1};
+      }
+      
+      // the arguments may refer to elements the split is about to move
+      value_type tmp{std::forward<Args>(args)...};
+      
+      auto const split = (difference_type ) SplitPolicy::insert_split(node_size);
+      auto new_node = split_node(*curr);
+      if (pos > split) {
+        curr = new_node;
+        pos -= split;
+      }
+      
+      curr->vec.emplace(curr->vec.begin() + pos, std::move(tmp));
+      curr->add(curr->vec[pos]);
+      index_resized(curr, 1);
       ++size_;
+      return iterator{curr, pos};
+    }
+    
+    iterator insert(iterator it, const_reference val)
+    {
+      return emplace(it, val);
+    }
+    
+    template <typename Range>
+    void append_range(Range&& range)
+    {
+      using std::begin;
+      using std::end;
+      
+      auto first = begin(range);
+      auto last = end(range);
+      append_from(
+        first, last,
+        typename std::iterator_traits<decltype(first)>::iterator_category{});
+    }
+    
+    // replaces the contents, the old nodes get refilled instead of
+    // going back to the allocator
+    template <
+      typename InputIt,
+      typename = typename std::iterator_traits<InputIt>::iterator_category
+    >
+    void assign(InputIt first, InputIt last)
+    {
+      auto curr = head_->next;
+      while (curr != nullptr) {
+        auto tmp = curr;
+        curr = curr->next;
+        
+        tmp->vec.clear();
+        tmp->summarize();
+        add_spare(tmp);
+      }
+      reset_head();
+      
+      append_from(
+        first, last,
+        typename std::iterator_traits<InputIt>::iterator_category{});
+    }
+    
+    void assign(std::initializer_list<value_type> init)
+    {
+      assign(init.begin(), init.end());
+    }
+    
+    /**
+      * Erase the element at it and return an iterator to the one
+      * after it. Emptied nodes are released and a node that drops
+      * under the policy's merge threshold is merged with a neighbour
+      * that's under it as well.
+      */
+    iterator erase(iterator it)
+    {
+      auto curr = it.curr_node_;
+      auto pos = it.pos_;
+      
+      curr->vec.erase(curr->vec.begin() + pos);
+      curr->summarize();
+      index_resized(curr, -1);
+      --size_;
+      
+      if (curr->vec.size() == 0) {
+        // the last node standing is kept around even when empty
+        if (node_count_ == 1) {
+          return end();
+        }
+        
+        auto next = curr->next;
+        remove_node(curr);
+        return next != nullptr ? iterator{next, 0} : end();
+      }
+      
+      auto const threshold = SplitPolicy::merge_threshold(node_size);
+      if (curr->vec.size() < threshold) {
+        auto next = curr->next;
+        auto prev = curr->prev;
+        
+        if (next != nullptr && next->vec.size() < threshold) {
+          auto const moved = (difference_type ) next->vec.size();
+          curr->vec.splice(next->vec, 0);
+          curr->summarize();
+          index_resized(curr, moved);
+          index_resized(next, -moved);
+          remove_node(next);
+        } else if (prev != nullptr && prev->vec.size() < threshold) {
+          auto const moved = (difference_type ) curr->vec.size();
+          pos += prev->vec.size();
+          prev->vec.splice(curr->vec, 0);
+          prev->summarize();
+          index_resized(prev, moved);
+          index_resized(curr, -moved);
+          remove_node(curr);
+          curr = prev;
+        }
+      }
+      
+      return make_iterator(curr, pos);
+    }
+    
+    /**
+      * Erases every element pred returns true for in a single pass
+      * over the nodes and returns how many there were. Each node gets
+      * compacted in place, emptied nodes go back to the allocator and
+      * a node that ends up under the merge threshold is moved into the
+      * node before it when they fit together (or the other way around),
+      * so every element is moved at most once. All iterators are
+      * invalidated.
+      */
+    template <typename Pred>
+    size_type erase_if(Pred pred)
+    {
+      auto const threshold = SplitPolicy::merge_threshold(node_size);
+      auto const test = [&pred](const_reference val)
+      {
+        return pred(val);
+      };
+      
+      size_type erased = 0;
+      auto curr = head_;
+      while (curr != nullptr) {
+        prefetch_ahead(curr);
+        auto const next = curr->next;
+        
+        auto const removed = curr->vec.erase_if(test);
+        if (removed > 0) {
+          erased += removed;
+          index_dirty_ = true;
+        }
+        
+        auto const prev = curr->prev;
+        auto const size = curr->vec.size();
+        if (size == 0 && node_count_ > 1) {
+          remove_node(curr);
+        } else if (
+          prev != nullptr && prev->vec.size() + size <= node_size &&
+          (size < threshold || prev->vec.size() < threshold))
+        {
+          auto const old_size = prev->vec.size();
+          prev->vec.splice(curr->vec, 0);
+          for (auto ptr = prev->vec.begin() + old_size; ptr != prev->vec.end(); ++ptr) {
+            prev->add(*ptr);
+          }
+          index_dirty_ = true;
+          remove_node(curr);
+        } else if (removed > 0) {
+          curr->summarize();
+        }
+        
+        curr = next;
+      }
+      
+      size_ -= erased;
+      return erased;
+    }
+    
+    // std::list's name for erase_if()
+    template <typename Pred>
+    size_type remove_if(Pred pred)
+    {
+      return erase_if(pred);
+    }
+    
+    // erases every element equal to val, which may be one of them
+    size_type remove(const_reference val)
+    {
+      auto const target = val;
+      return erase_if([&target](const_reference elem)
+      {
+        return elem == target;
+      });
+    }
+    
+    void pop_back(void)
+    {
+      erase(--end());
+    }
+    
+    void pop_front(void)
+    {
+      erase(begin());
+    }
+    
+    /**
+      * Repacks the elements into full nodes, walking the list in order
+      * and filling every node from the ones after it, for at most
+      * budget nodes. Each one costs no more than about a node's worth
+      * of element moves, so a latency sensitive caller can spread a
+      * pass over many calls. The next call picks up where this one
+      * stopped. Returns true once a pass has reached the end of the list.
+      * All iterators are invalidated.
+      */
+    bool compact(size_type budget)
+    {
+      auto curr = compact_from_ != nullptr ? compact_from_ : head_;
+      for (; curr != nullptr && budget > 0; --budget) {
+        prefetch_ahead(curr);
+        fill_node(curr);
+        curr = curr->next;
+      }
+      
+      compact_from_ = curr;
+      return curr == nullptr;
+    }
+    
+    // a full compact() pass that also gives the spare nodes back
+    void shrink_to_fit(void)
+    {
+      compact_from_ = nullptr;
+      compact(node_count_);
+      
+      while (spare_ != nullptr) {
+        auto tmp = spare_;
+        spare_ = spare_->next;
+        destroy_node(tmp);
+      }
+      spare_count_ = 0;
+    }
+    
+    // drops every element and hands all nodes but the head back
+    // to the allocator, spare nodes stay around
+    void clear(void)
+    {
+      auto curr = head_->next;
+      while (curr != nullptr) {
+        auto tmp = curr;
+        curr = curr->next;
+        destroy_node(tmp);
+      }
+      reset_head();
     }
   };
 }
@@ -0,0 +1,236 @@
+#ifndef REGULUS_ZONE_MAP_HPP_
+#define REGULUS_ZONE_MAP_HPP_
+
+#include <cstddef>
+#include <utility>
+
+#include "unrolled-list.hpp"
+
+/**
+  * Zone maps for unrolled_list: node summaries that know the bounds of
+  * their elements, and scans that look at a node's summary before its
+  * elements. A node that can't hold a match gets skipped without ever
+  * being read and a node where everything matches gets handled without
+  * testing a single element, so a selective filter over data that's
+  * more or less ordered only touches the few nodes on its boundaries.
+  *
+  * The summaries are kept up to date by everything that adds or removes
+  * elements, by unrolled_list::modify() and by the mutating segmented
+  * and parallel algorithms. Writes through iterators or operator[]
+  * aren't seen, so they have to go through modify() instead.
+  */
+namespace regulus
+{
+  // minmax_summary plus the number of elements
+  template <typename T>
+  struct zone_summary : minmax_summary<T>
+  {
+    std::size_t count;
+    
+    zone_summary(void)
+      : count{0}
+    {}
+    
+    void add(T const& val)
+    {
+      minmax_summary<T>::add(val);
+      ++count;
+    }
+    
+    template <typename It>
+    void assign(It first, It last)
+    {
+      this->empty = true;
+      count = 0;
+      for (; first != last; ++first) {
+        add(*first);
+      }
+    }
+  };
+  
+  /**
+    * zone_summary plus the sum of the elements. Sum should be wide
+    * enough to hold a full node's worth, like long long for ints.
+    */
+  template <typename T, typename Sum = T>
+  struct summed_zone_summary : zone_summary<T>
+  {
+    Sum sum;
+    
+    summed_zone_summary(void)
+      : sum{}
+    {}
+    
+    void add(T const& val)
+    {
+      zone_summary<T>::add(val);
+      sum += val;
+    }
+    
+    template <typename It>
+    void assign(It first, It last)
+    {
+      this->empty = true;
+      this->count = 0;
+      sum = Sum{};
+      for (; first != last; ++first) {
+        add(*first);
+      }
+    }
+  };
+  
+  /**
+    * Matches the elements inside a closed interval, either end of which
+    * may be left open. Zone scans take any predicate that has
+    * may_match(summary), true when a node might hold a match, and
+    * all_match(summary), true when every element of the node matches.
+    */
+  template <typename T>
+  class range_predicate
+  {
+  private:
+    T    lo_;
+    T    hi_;
+    bool has_lo_;
+    bool has_hi_;
+  
+  public:
+    range_predicate(T const& lo, bool const has_lo, T const& hi, bool const has_hi)
+      : lo_{lo}
+      , hi_{hi}
+      , has_lo_{has_lo}
+      , has_hi_{has_hi}
+    {}
+    
+    bool operator()(T const& val) const
+    {
+      return !(has_lo_ && val < lo_) && !(has_hi_ && hi_ < val);
+    }
+    
+    template <typename Summary>
+    bool may_match(Summary const& summary) const
+    {
+      return
+        !summary.empty &&
+        !(has_lo_ && summary.max < lo_) &&
+        !(has_hi_ && hi_ < summary.min);
+    }
+    
+    template <typename Summary>
+    bool all_match(Summary const& summary) const
+    {
+      return
+        !summary.empty &&
+        !(has_lo_ && summary.min < lo_) &&
+        !(has_hi_ && hi_ < summary.max);
+    }
+  };
+  
+  // lo <= x && x <= hi
+  template <typename T>
+  range_predicate<T> between(T const& lo, T const& hi)
+  {
+    return range_predicate<T>{lo, true, hi, true};
+  }
+  
+  template <typename T>
+  range_predicate<T> at_least(T const& lo)
+  {
+    return range_predicate<T>{lo, true, lo, false};
+  }
+  
+  template <typename T>
+  range_predicate<T> at_most(T const& hi)
+  {
+    return range_predicate<T>{hi, false, hi, true};
+  }
+  
+  template <typename T, std::size_t N, typename ...Options, typename Pred>
+  typename unrolled_list<T, N, Options...>::iterator
+  zone_find_if(unrolled_list<T, N, Options...> const& list, Pred pred)
+  {
+    auto result = list.end();
+    list.scan_segments([&](auto seg)
+    {
+      if (!pred.may_match(seg.summary())) {
+        return true;
+      }
+      
+      for (auto ptr = seg.begin(), end = seg.end(); ptr != end; ++ptr) {
+        if (pred(*ptr)) {
+          result = list.to_iterator(seg, ptr);
+          return false;
+        }
+      }
+      return true;
+    });
+    return result;
+  }
+  
+  template <typename T, std::size_t N, typename ...Options, typename Pred>
+  std::size_t zone_count_if(unrolled_list<T, N, Options...> const& list, Pred pred)
+  {
+    std::size_t total = 0;
+    list.scan_segments([&](auto seg)
+    {
+      if (pred.all_match(seg.summary())) {
+        total += seg.size();
+      } else if (pred.may_match(seg.summary())) {
+        for (auto ptr = seg.begin(), end = seg.end(); ptr != end; ++ptr) {
+          total += pred(*ptr);
+        }
+      }
+      return true;
+    });
+    return total;
+  }
+  
+  // calls f on every element that matches pred, in order
+  template <typename T, std::size_t N, typename ...Options, typename Pred, typename F>
+  F zone_for_each_if(unrolled_list<T, N, Options...> const& list, Pred pred, F f)
+  {
+    list.scan_segments([&](auto seg)
+    {
+      if (pred.all_match(seg.summary())) {
+        for (auto ptr = seg.begin(), end = seg.end(); ptr != end; ++ptr) {
+          f(*ptr);
+        }
+      } else if (pred.may_match(seg.summary())) {
+        for (auto ptr = seg.begin(), end = seg.end(); ptr != end; ++ptr) {
+          if (pred(*ptr)) {
+            f(*ptr);
+          }
+        }
+      }
+      return true;
+    });
+    return f;
+  }
+  
+  /**
+    * Adds up the elements that match pred. Needs summed_zone_summary
+    * (or anything else with a sum), nodes that match completely just
+    * contribute their summary's sum.
+    */
+  template <typename T, std::size_t N, typename ...Options, typename Pred, typename U>
+  U zone_sum_if(unrolled_list<T, N, Options...> const& list, Pred pred, U init)
+  {
+    list.scan_segments([&](auto seg)
+    {
+      auto const& summary = seg.summary();
+      if (pred.all_match(summary)) {
+        init += summary.sum;
+      } else if (pred.may_match(summary)) {
+        for (auto ptr = seg.begin(), end = seg.end(); ptr != end; ++ptr) {
+          if (pred(*ptr)) {
+            init += *ptr;
+          }
+        }
+      }
+      return true;
+    });
+    return init;
+  }
+}
+
+#endif // REGULUS_ZONE_MAP_HPP_
@@ -1,12 +1,383 @@
 #include <cassert>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <numeric>
 #include <ctime>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <stdexcept>
 #include <list>
+#include <deque>
+#include <queue>
+#include <set>
+#include <functional>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <sstream>
+#include <string>
+#include <iterator>
+#include <type_traits>
 
 #include "include/unrolled-list.hpp"
+#include "include/segmented-algorithm.hpp"
+#include "include/parallel.hpp"
+#include "include/concurrent-unrolled-list.hpp"
+#include "include/segmented-queue.hpp"
+#include "include/sorted-unrolled-list.hpp"
+#include "include/zone-map.hpp"
+#include "include/simd-algorithm.hpp"
 
 using regulus::unrolled_list;
 
+namespace
+{
+  /**
+    * Hands out equally sized slots of one big buffer in random order
+    * so neighbouring nodes end up scattered all over it, like they do
+    * in a list that's been built up over hours. Nothing is reused.
+    */
+  class scatter_arena
+  {
+  private:
+    std::vector<char>        buffer_;
+    std::vector<std::size_t> order_;
+    std::size_t              slot_size_;
+    std::size_t              next_;
+  
+  public:
+    explicit scatter_arena(std::size_t const slots)
+      : order_(slots)
+      , slot_size_{0}
+      , next_{0}
+    {
+      std::iota(order_.begin(), order_.end(), 0);
+      std::shuffle(order_.begin(), order_.end(), std::mt19937{1337});
+    }
+    
+    void* allocate(std::size_t const size, std::size_t const align)
+    {
+      if (slot_size_ == 0) {
+        slot_size_ = (size + align - 1) / align * align;
+        buffer_.resize(slot_size_ * order_.size() + align);
+      }
+      assert(size <= slot_size_ && next_ < order_.size());
+      
+      void* base = buffer_.data();
+      auto space = buffer_.size();
+      std::align(align, slot_size_ * order_.size(), base, space);
+      return static_cast<char*>(base) + order_[next_++] * slot_size_;
+    }
+  };
+  
+  template <typename T>
+  struct scattered_allocator
+  {
+    typedef T value_type;
+    
+    std::shared_ptr<scatter_arena> arena;
+    
+    explicit scattered_allocator(std::shared_ptr<scatter_arena> a)
+      : arena{std::move(a)}
+    {}
+    
+    template <typename U>
+    scattered_allocator(scattered_allocator<U> const& other)
+      : arena{other.arena}
+    {}
+    
+    T* allocate(std::size_t const count)
+    {
+      assert(count == 1);
+      return static_cast<T*>(arena->allocate(sizeof(T), alignof(T)));
+    }
+    
+    void deallocate(T*, std::size_t)
+    {}
+    
+    template <typename U>
+    bool operator==(scattered_allocator<U> const& other) const
+    {
+      return arena == other.arena;
+    }
+    
+    template <typename U>
+    bool operator!=(scattered_allocator<U> const& other) const
+    {
+      return !(*this == other);
+    }
+  };
+  
+  struct no_prefetch_policy : regulus::fill_split_policy
+  {
+    static constexpr std::size_t prefetch_distance = 0;
+  };
+  
+  struct far_prefetch_policy : regulus::fill_split_policy
+  {
+    static constexpr std::size_t prefetch_distance = 4;
+  };
+  
+  struct minmax_policy : regulus::fill_split_policy
+  {
+    template <typename T>
+    using summary = regulus::minmax_summary<T>;
+  };
+  
+  struct zone_policy : regulus::fill_split_policy
+  {
+    template <typename T>
+    using summary = regulus::summed_zone_summary<T, long long>;
+  };
+  
+  // only says how to split, everything else is left at the defaults
+  struct bare_split_policy
+  {
+    static constexpr std::size_t append_split(std::size_t const capacity)
+    {
+      return capacity;
+    }
+    
+    static constexpr std::size_t insert_split(std::size_t const capacity)
+    {
+      return capacity / 2;
+    }
+    
+    static constexpr std::size_t merge_threshold(std::size_t const capacity)
+    {
+      return capacity / 4;
+    }
+  };
+  
+  // adds up string lengths, and the partial sums of several threads
+  struct string_length_sum
+  {
+    std::size_t operator()(std::size_t const acc, std::string const& s) const
+    {
+      return acc + s.size();
+    }
+    
+    std::size_t operator()(std::size_t const a, std::size_t const b) const
+    {
+      return a + b;
+    }
+  };
+  
+  // a range predicate that counts how many elements it got to see
+  struct counted_range : regulus::range_predicate<int>
+  {
+    std::size_t* calls;
+    
+    counted_range(regulus::range_predicate<int> const& pred, std::size_t* calls)
+      : regulus::range_predicate<int>{pred}
+      , calls{calls}
+    {}
+    
+    bool operator()(int const val) const
+    {
+      ++*calls;
+      return regulus::range_predicate<int>::operator()(val);
+    }
+  };
+  
+  // std::allocator that keeps count of how often it was called
+  template <typename T>
+  struct counting_allocator : std::allocator<T>
+  {
+    static std::size_t allocations;
+    
+    template <typename U>
+    struct rebind
+    {
+      typedef counting_allocator<U> other;
+    };
+    
+    counting_allocator(void)
+    {}
+    
+    template <typename U>
+    counting_allocator(counting_allocator<U> const&)
+    {}
+    
+    T* allocate(std::size_t const count)
+    {
+      ++allocations;
+      return std::allocator<T>::allocate(count);
+    }
+  };
+  
+  template <typename T>
+  std::size_t counting_allocator<T>::allocations = 0;
+  
+  // a key that knows which instances are alive, so copying or moving
+  // from one that's already been destroyed trips an assert
+  struct tracked_key
+  {
+    static std::set<tracked_key const*> alive;
+    
+    int val;
+    
+    tracked_key(void)
+      : val{0}
+    {
+      alive.insert(this);
+    }
+    
+    tracked_key(int const val)
+      : val{val}
+    {
+      alive.insert(this);
+    }
+    
+    tracked_key(tracked_key const& other)
+      : val{other.val}
+    {
+      assert(alive.count(&other) == 1);
+      alive.insert(this);
+    }
+    
+    tracked_key(tracked_key&& other)
+      : val{other.val}
+    {
+      assert(alive.count(&other) == 1);
+      alive.insert(this);
+    }
+    
+    tracked_key& operator=(tracked_key const& other)
+    {
+      assert(alive.count(&other) == 1 && alive.count(this) == 1);
+      val = other.val;
+      return *this;
+    }
+    
+    ~tracked_key(void)
+    {
+      alive.erase(this);
+    }
+    
+    bool operator<(tracked_key const& other) const
+    {
+      return val < other.val;
+    }
+  };
+  
+  std::set<tracked_key const*> tracked_key::alive;
+  
+  // pushes and pops through a queue that holds on to `depth` elements
+  template <typename Queue>
+  double run_queue(int const depth, int const rounds, long long& sum)
+  {
+    Queue queue;
+    for (int i = 0; i < depth; ++i) {
+      queue.push(i);
+    }
+    
+    auto begin = std::clock();
+    for (int i = 0; i < rounds; ++i) {
+      sum += queue.front();
+      queue.pop();
+      queue.push(i);
+    }
+    auto end = std::clock();
+    
+    return double{(double ) end - begin} / CLOCKS_PER_SEC;
+  }
+  
+  // iterates over a list whose nodes are scattered all over the heap
+  template <typename Policy>
+  double scattered_scan(int const num_elements, int const passes)
+  {
+    typedef unrolled_list<
+      int, unrolled_list<int>::node_size,
+      Policy, scattered_allocator<int>> list_type;
+    
+    auto arena = std::make_shared<scatter_arena>(
+      num_elements / list_type::node_size + 2);
+    list_type list{scattered_allocator<int>{arena}};
+    for (int i = 0; i < num_elements; ++i) {
+      list.emplace_back(i);
+    }
+    
+    long long sum = 0;
+    auto begin = std::clock();
+    for (int i = 0; i < passes; ++i) {
+      for (auto l : list) {
+        sum += l;
+      }
+    }
+    auto end = std::clock();
+    
+    assert(sum == (long long ) passes * num_elements * (num_elements - 1) / 2);
+    return double{(double ) end - begin} / CLOCKS_PER_SEC;
+  }
+  
+  /**
+    * Splits a node somewhere in a scattered list and looks up an
+    * element right after, so every pass renumbers the nodes after
+    * the split. That's a walk over the node headers only.
+    */
+  double scattered_reindex(int const num_elements, int const passes)
+  {
+    typedef unrolled_list<
+      int, unrolled_list<int>::node_size,
+      regulus::fill_split_policy, scattered_allocator<int>> list_type;
+    
+    auto arena = std::make_shared<scatter_arena>(
+      num_elements / list_type::node_size + passes + 2);
+    list_type list{scattered_allocator<int>{arena}};
+    for (int i = 0; i < num_elements; ++i) {
+      list.emplace_back(i);
+    }
+    
+    auto const stride = list.size() / passes;
+    long long sum = 0;
+    
+    auto begin = std::clock();
+    for (int i = 0; i < passes; ++i) {
+      auto it = list.iterator_at(i * stride);
+      sum += *it;
+      list.emplace(it, 0);
+    }
+    auto end = std::clock();
+    
+    assert(sum > 0);
+    return double{(double ) end - begin} / CLOCKS_PER_SEC;
+  }
+  
+  /**
+    * Inserts at a random position in the first or last sixteenth of
+    * the list and reads a random element back every round. A split
+    * near the front renumbers almost every node after it, which is
+    * the index's worst case, one near the back only a few.
+    */
+  double indexed_inserts(int const num_elements, int const rounds, bool const front)
+  {
+    unrolled_list<int> list;
+    for (int i = 0; i < num_elements; ++i) {
+      list.emplace_back(i);
+    }
+    
+    std::mt19937 gen{99};
+    long long sum = 0;
+    
+    auto begin = std::clock();
+    for (int i = 0; i < rounds; ++i) {
+      auto const window = list.size() / 16;
+      auto const offset = gen() % window;
+      auto const pos = front ? offset : list.size() - window + offset;
+      list.insert(list.iterator_at(pos), i);
+      sum += list[gen() % list.size()];
+    }
+    auto end = std::clock();
+    
+    assert(sum > 0);
+    return double{(double ) end - begin} / CLOCKS_PER_SEC;
+  }
+}
+
 int main(void)
 {
   // It should be default constructible
@@ -94,44 +465,1837 @@ int main(void)
     assert(std::distance(list.begin(), list.end()) == new_size);
   }
   
-  int num_elements = 1024 * 1024 * 2;
+  // it should support custom node sizes
+  {
+    unrolled_list<int, 8> list;
+    static_assert(decltype(list)::node_size == 8, "");
+    
+    for (int i = 0; i < 64; ++i) {
+      list.emplace_back(i);
+    }
+    
+    assert(list.node_count() == 8);
+    
+    int i = 0;
+    for (auto l : list) {
+      assert(l == i);
+      ++i;
+    }
+  }
   
-  double my_time = 0;
-  double stl_time = 0;
+  // appending should fill nodes completely by default and
+  // half-fill them with the half split policy
+  {
+    unrolled_list<int, 16> packed;
+    unrolled_list<int, 16, regulus::half_split_policy> halved;
+    
+    for (int i = 0; i < 1024; ++i) {
+      packed.emplace_back(i);
+      halved.emplace_back(i);
+    }
+    
+    assert(packed.node_count() == 1024 / 16);
+    assert(halved.node_count() == 1024 / 8 - 1);
+    
+    assert(std::equal(packed.begin(), packed.end(), halved.begin()));
+  }
   
+  // the default node size should fill a few cache lines
   {
-    auto begin = std::clock();
-    regulus::unrolled_list<int> list;
-    for (int i = 0; i < num_elements; ++i) {
+    static_assert(unrolled_list<int>::node_size == 64, "");
+    static_assert(unrolled_list<double>::node_size == 32, "");
+    
+    struct big { char data[512]; };
+    static_assert(unrolled_list<big>::node_size == 2, "");
+  }
+  
+  // it should work with a pool allocator
+  {
+    typedef unrolled_list<
+      int, 16,
+      regulus::fill_split_policy,
+      regulus::pool_allocator<int>> pool_list;
+    
+    regulus::pool_allocator<int> alloc;
+    pool_list a{alloc};
+    pool_list b{alloc};
+    
+    assert(a.get_allocator() == b.get_allocator());
+    
+    for (int i = 0; i < 1024; ++i) {
+      a.emplace_back(i);
+      b.emplace_back(-i);
+    }
+    
+    int i = 0;
+    for (auto l : a) {
+      assert(l == i);
+      ++i;
+    }
+    
+    i = 0;
+    for (auto l : b) {
+      assert(l == -i);
+      ++i;
+    }
+    
+    // cleared nodes should be recycled
+    a.clear();
+    assert(a.size() == 0);
+    assert(a.node_count() == 1);
+    assert(a.begin() == a.end());
+    
+    for (int i = 0; i < 1024; ++i) {
+      a.emplace_back(i);
+    }
+    assert(a.size() == 1024);
+    assert(std::distance(a.begin(), a.end()) == 1024);
+  }
+  
+  // the pool should carve consecutive nodes out of the same block
+  // and reuse freed ones first
+  {
+    regulus::pool_allocator<double> alloc;
+    
+    auto a = alloc.allocate(1);
+    auto b = alloc.allocate(1);
+    assert(b == a + 1);
+    
+    alloc.deallocate(a, 1);
+    auto c = alloc.allocate(1);
+    assert(c == a);
+    
+    alloc.deallocate(b, 1);
+    alloc.deallocate(c, 1);
+    
+    // anything the size of a node starts on a cache line
+    struct big
+    {
+      char bytes[200];
+    };
+    regulus::pool_allocator<big> big_alloc;
+    
+    auto d = big_alloc.allocate(1);
+    auto e = big_alloc.allocate(1);
+    assert(reinterpret_cast<std::uintptr_t>(d) % 64 == 0);
+    assert(reinterpret_cast<std::uintptr_t>(e) % 64 == 0);
+    
+    big_alloc.deallocate(d, 1);
+    big_alloc.deallocate(e, 1);
+  }
+  
+  // it should support front and back operations
+  {
+    unrolled_list<int, 4> list;
+    for (int i = 0; i < 8; ++i) {
+      list.emplace_back(i);
+      list.emplace_front(-i - 1);
+    }
+    
+    assert(list.size() == 16);
+    assert(list.front() == -8);
+    assert(list.back() == 7);
+    
+    int i = -8;
+    for (auto l : list) {
+      assert(l == i);
+      ++i;
+    }
+    
+    for (int i = 0; i < 8; ++i) {
+      list.pop_front();
+      list.pop_back();
+    }
+    
+    assert(list.size() == 0);
+    assert(list.node_count() == 1);
+    assert(list.begin() == list.end());
+  }
+  
+  // inserting into the middle of a full node should split it
+  {
+    unrolled_list<int, 8> list;
+    for (int i = 0; i < 16; ++i) {
+      list.emplace_back(i < 4 ? i : i + 1);
+    }
+    assert(list.node_count() == 2);
+    
+    auto it = list.begin();
+    std::advance(it, 4);
+    
+    it = list.insert(it, 4);
+    assert(*it == 4);
+    assert(list.node_count() == 3);
+    
+    int i = 0;
+    for (auto l : list) {
+      assert(l == i);
+      ++i;
+    }
+    assert(i == 17);
+  }
+  
+  // erasing should return the next element and merge sparse nodes
+  {
+    unrolled_list<int, 16, regulus::half_split_policy> list;
+    for (int i = 0; i < 64; ++i) {
       list.emplace_back(i);
     }
     
+    auto const nodes = list.node_count();
+    
+    // erase 3 out of every 4 elements
     auto it = list.begin();
-    do {
-      ++it;
-    } while (it != list.end());
+    for (int i = 0; it != list.end(); ++i) {
+      if (i % 4 == 3) {
+        ++it;
+        continue;
+      }
+      
+      auto const val = *it;
+      it = list.erase(it);
+      if (it != list.end()) {
+        assert(*it == val + 1);
+      }
+    }
     
-    auto end = std::clock();
-    my_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    assert(list.size() == 16);
+    assert(list.node_count() < nodes);
+    
+    int i = 3;
+    for (auto l : list) {
+      assert(l == i);
+      i += 4;
+    }
   }
   
+  // erase_if should compact nodes and merge the sparse ones in one pass
   {
-    auto begin = std::clock();
+    typedef unrolled_list<int, 16> list_type;
     
-    std::list<int> list_;
-    for (int i = 0; i < num_elements; ++i) {
-      list_.emplace_back(i);
+    // no two neighbouring nodes are both under the merge threshold
+    auto check_nodes = [](list_type const& list)
+    {
+      auto const threshold = regulus::fill_split_policy::merge_threshold(16);
+      std::size_t prev = 16;
+      std::size_t total = 0;
+      for (auto seg : list.segments()) {
+        assert(seg.size() > 0 || list.size() == 0);
+        assert(seg.size() >= threshold || prev >= threshold);
+        prev = seg.size();
+        total += seg.size();
+      }
+      assert(total == list.size());
+    };
+    
+    list_type list;
+    std::vector<int> expected;
+    for (int i = 0; i < 1000; ++i) {
+      list.emplace_back(i);
+      expected.push_back(i);
     }
     
-    auto it = list_.begin();
-    do {
-      ++it;
-    } while (it != list_.end());
+    auto const odd = [](int const x) { return x % 2 == 1; };
+    assert(list.erase_if(odd) == 500);
+    expected.erase(std::remove_if(expected.begin(), expected.end(), odd), expected.end());
+    assert(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+    assert(list.node_count() == 63);
+    check_nodes(list);
     
-    auto end = std::clock();
-    stl_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    // that leaves a single element in every node, they get merged into full ones
+    auto const sparse = [](int const x) { return x % 16 != 0; };
+    assert(list.erase_if(sparse) == 437);
+    expected.erase(std::remove_if(expected.begin(), expected.end(), sparse), expected.end());
+    assert(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+    assert(list.node_count() == 4);
+    check_nodes(list);
+    assert(list[40] == 640 && list.back() == 992);
+    
+    list.emplace_back(1000);
+    list.insert(list.iterator_at(5), -1);
+    assert(list.size() == 65 && list[5] == -1 && list.back() == 1000);
+    
+    assert(list.remove(list.front()) == 1 && list.front() == 16);
+    assert(list.remove_if([](int) { return false; }) == 0);
+    assert(list.erase_if([](int) { return true; }) == 64);
+    assert(list.size() == 0 && list.node_count() == 1 && list.begin() == list.end());
+    list.emplace_back(7);
+    assert(list.front() == 7 && list.size() == 1);
+    
+    // random sweeps over strings should match a std::vector
+    std::mt19937 gen{99};
+    unrolled_list<std::string, 8> strs;
+    for (int i = 0; i < 2000; ++i) {
+      auto const val = std::to_string(gen() % 1000);
+      strs.insert(strs.iterator_at(gen() % (strs.size() + 1)), val);
+      if (i % 400 == 399) {
+        auto const cut = std::to_string(gen() % 10);
+        auto const pred = [&cut](std::string const& s) { return s.back() == cut[0]; };
+        std::vector<std::string> before(strs.begin(), strs.end());
+        auto const erased = strs.erase_if(pred);
+        before.erase(std::remove_if(before.begin(), before.end(), pred), before.end());
+        assert(erased > 0);
+        assert(std::equal(strs.begin(), strs.end(), before.begin(), before.end()));
+        assert(strs[strs.size() / 2] == before[before.size() / 2]);
+      }
+    }
+  }
+  
+  // erase_if shouldn't need a default constructor
+  {
+    struct no_default
+    {
+      int val;
+      
+      explicit no_default(int v)
+        : val{v}
+      {}
+    };
+    
+    unrolled_list<no_default, 8> list;
+    for (int i = 0; i < 100; ++i) {
+      list.emplace_back(i);
+    }
+    list.erase(list.begin());
+    
+    assert(list.remove_if([](no_default const& nd) { return nd.val % 3 != 0; }) == 66);
+    assert(list.erase_if([](no_default const& nd) { return nd.val > 90; }) == 3);
+    assert(list.size() == 30 && list.front().val == 3 && list.back().val == 90);
+  }
+  
+  // shrink_to_fit should repack everything into full nodes
+  {
+    unrolled_list<int, 16, regulus::half_split_policy> list;
+    for (int i = 0; i < 1024; ++i) {
+      list.emplace_back(i);
+    }
+    list.reserve(2000);
+    assert(list.node_count() == 1024 / 8 - 1);
+    
+    list.shrink_to_fit();
+    assert(list.node_count() == 1024 / 16);
+    assert(list.capacity() == 1024);
+    for (auto seg : list.segments()) {
+      assert(seg.size() == 16);
+    }
+    
+    int i = 0;
+    for (auto l : list) {
+      assert(l == i);
+      ++i;
+    }
+    assert(i == 1024);
+    assert(list[700] == 700 && list.back() == 1023);
+    
+    list.emplace_back(1024);
+    assert(list.size() == 1025 && list.node_count() == 65);
+    
+    unrolled_list<std::string, 8> strs;
+    for (int i = 0; i < 100; ++i) {
+      strs.insert(strs.begin(), std::to_string(i));
+    }
+    strs.shrink_to_fit();
+    assert(strs.node_count() == 13 && strs.front() == "99" && strs.back() == "0");
+  }
+  
+  // compact() should spread a pass over several calls
+  {
+    unrolled_list<int, 16> list;
+    for (int i = 0; i < 4096; ++i) {
+      list.emplace_back(i);
+    }
+    list.erase_if([](int const x) { return x % 64 >= 8; });
+    list.emplace(list.begin(), -1);
+    assert(list.size() == 513 && list.node_count() == 64);
+    
+    auto nodes = list.node_count();
+    int calls = 0;
+    bool done = false;
+    while (!done) {
+      done = list.compact(4);
+      assert(list.node_count() <= nodes);
+      nodes = list.node_count();
+      
+      // nodes going away underneath a pass shouldn't bother it
+      if (++calls == 3) {
+        list.erase_if([](int const x) { return x % 64 == 1; });
+      }
+    }
+    assert(calls > 3);
+    assert(list.size() == 449 && list.node_count() < 32);
+    
+    auto it = list.begin();
+    assert(*it == -1);
+    for (int i = 0; i < 4096; ++i) {
+      if (i % 64 < 8 && i % 64 != 1) {
+        assert(*++it == i);
+      }
+    }
+    assert(++it == list.end());
+    
+    // the next pass starts over at the head and packs the nodes the
+    // erase left behind
+    while (!list.compact(4)) {
+    }
+    assert(list.node_count() == 29 && list[448] == 4039);
+  }
+  
+  // random inserts and erases should match a std::vector
+  {
+    std::mt19937 gen{1337};
+    unrolled_list<int, 8> list;
+    std::vector<int> expected;
+    
+    for (int round = 0; round < 20000; ++round) {
+      bool const do_insert = expected.empty() || gen() % 3 != 0;
+      auto const pos = gen() % (expected.size() + (do_insert ? 1 : 0));
+      
+      auto it = list.begin();
+      std::advance(it, pos);
+      
+      if (do_insert) {
+        auto const val = (int ) gen();
+        auto res = list.insert(it, val);
+        expected.insert(expected.begin() + pos, val);
+        assert(*res == val);
+      } else {
+        auto res = list.erase(it);
+        auto exp = expected.erase(expected.begin() + pos);
+        assert((res == list.end()) == (exp == expected.end()));
+        if (exp != expected.end()) {
+          assert(*res == *exp);
+        }
+      }
+      
+      assert(list.size() == expected.size());
+    }
+    
+    assert(std::distance(list.begin(), list.end()) == (long ) expected.size());
+    assert(std::equal(expected.begin(), expected.end(), list.begin()));
+  }
+  
+  // it should support indexed access
+  {
+    unrolled_list<int, 16> list;
+    for (int i = 0; i < 1000; ++i) {
+      list.emplace_back(i);
+    }
+    
+    for (int i = 0; i < 1000; ++i) {
+      assert(list[i] == i);
+      assert(*list.iterator_at(i) == i);
+      assert(list.index_of(list.iterator_at(i)) == (std::size_t ) i);
+    }
+    assert(list.iterator_at(1000) == list.end());
+    assert(list.index_of(list.end()) == 1000);
+    
+    // the index should follow along as we keep appending
+    for (int i = 1000; i < 2000; ++i) {
+      list.emplace_back(i);
+      assert(list[i] == i);
+      assert(list[i / 2] == i / 2);
+    }
+    
+    try {
+      list.at(2000);
+      assert(false);
+    } catch (std::out_of_range& e) {
+    }
+  }
+  
+  // indexed access should stay correct through splits and merges
+  {
+    std::mt19937 gen{42};
+    unrolled_list<int, 8> list;
+    std::vector<int> expected;
+    
+    for (int round = 0; round < 20000; ++round) {
+      auto const op = gen() % 5;
+      
+      if (op < 3 || expected.empty()) {
+        auto const pos = gen() % (expected.size() + 1);
+        auto const val = (int ) gen();
+        auto it = list.insert(list.iterator_at(pos), val);
+        expected.insert(expected.begin() + pos, val);
+        assert(list.index_of(it) == pos);
+      } else if (op == 3) {
+        auto const pos = gen() % expected.size();
+        list.erase(list.iterator_at(pos));
+        expected.erase(expected.begin() + pos);
+      } else {
+        list.emplace_back(round);
+        expected.push_back(round);
+      }
+      
+      if (!expected.empty()) {
+        auto const pos = gen() % expected.size();
+        assert(list[pos] == expected[pos]);
+      }
+    }
+    
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      assert(list[i] == expected[i]);
+    }
+    
+    while (list.size() > 0) {
+      list.pop_back();
+      expected.pop_back();
+      if (!expected.empty()) {
+        assert(list[expected.size() - 1] == expected.back());
+        assert(list[0] == expected.front());
+      }
+    }
+  }
+  
+  // it should expose its nodes as contiguous segments
+  {
+    unrolled_list<int, 16> list;
+    for (int i = 0; i < 100; ++i) {
+      list.emplace_back(i);
+    }
+    
+    int expected = 0;
+    std::size_t segments = 0;
+    for (auto seg : list.segments()) {
+      assert(seg.end() - seg.begin() == (long ) seg.size());
+      for (auto ptr = seg.begin(); ptr != seg.end(); ++ptr) {
+        assert(*ptr == expected);
+        ++expected;
+      }
+      ++segments;
+    }
+    assert(expected == 100);
+    assert(segments == list.node_count());
+    
+    std::size_t total = 0;
+    list.for_each_segment([&](int* first, int* last)
+    {
+      total += last - first;
+    });
+    assert(total == list.size());
+  }
+  
+  // it should iterate the same no matter how far ahead it prefetches
+  {
+    static_assert(unrolled_list<int>::prefetch_distance ==
+      REGULUS_PREFETCH_DISTANCE, "");
+    static_assert(unrolled_list<int, 4, no_prefetch_policy>::prefetch_distance == 0, "");
+    static_assert(unrolled_list<int, 4, far_prefetch_policy>::prefetch_distance == 4, "");
+    
+    unrolled_list<int, 4> near_list;
+    unrolled_list<int, 4, no_prefetch_policy> no_list;
+    unrolled_list<int, 4, far_prefetch_policy> far_list;
+    
+    // short enough that the far list runs out of nodes to prefetch
+    for (int i = 0; i < 10; ++i) {
+      near_list.emplace_back(i);
+      no_list.emplace_back(i);
+      far_list.emplace_back(i);
+    }
+    
+    assert(std::equal(near_list.begin(), near_list.end(), no_list.begin()));
+    assert(std::equal(near_list.begin(), near_list.end(), far_list.begin()));
+    assert(regulus::accumulate(far_list, 0) == 45);
+    
+    std::size_t total = 0;
+    far_list.for_each_segment([&](int* first, int* last)
+    {
+      total += last - first;
+    });
+    assert(total == 10);
+  }
+  
+  // it should fall back to the default node options for a bare split policy
+  {
+    typedef unrolled_list<int, 4, bare_split_policy> list_type;
+    static_assert(list_type::prefetch_distance == REGULUS_PREFETCH_DISTANCE, "");
+    static_assert(
+      std::is_same<list_type::summary_type, regulus::no_summary<int>>::value, "");
+    
+    list_type list;
+    for (int i = 0; i < 10; ++i) {
+      list.emplace_back(i);
+    }
+    list.insert(std::next(list.begin(), 2), 42);
+    assert(list.size() == 11 && list[2] == 42 && list.back() == 9);
+  }
+  
+  // it should work with nodes scattered over the heap
+  {
+    typedef unrolled_list<
+      int, 8, regulus::fill_split_policy, scattered_allocator<int>> list_type;
+    
+    auto arena = std::make_shared<scatter_arena>(64);
+    list_type list{scattered_allocator<int>{arena}};
+    for (int i = 0; i < 256; ++i) {
+      list.emplace_back(i);
+    }
+    
+    int expected = 0;
+    for (auto l : list) {
+      assert(l == expected);
+      ++expected;
+    }
+    assert(expected == 256);
+  }
+  
+  // it should be constructible from a range and fill its nodes
+  {
+    std::vector<int> src(100);
+    std::iota(src.begin(), src.end(), 0);
+    
+    unrolled_list<int, 16, regulus::half_split_policy> list(src.begin(), src.end());
+    assert(list.size() == 100);
+    assert(list.node_count() == 7);
+    assert(std::equal(src.begin(), src.end(), list.begin()));
+    assert(list[99] == 99 && list.index_of(--list.end()) == 99);
+    
+    // single-pass ranges work too
+    std::istringstream in{"1 2 3 4 5"};
+    unrolled_list<int, 4> parsed(
+      std::istream_iterator<int>{in}, std::istream_iterator<int>{});
+    assert(parsed.size() == 5);
+    assert(parsed.front() == 1 && parsed.back() == 5);
+  }
+  
+  // it should reserve exactly the nodes it needs and append into them
+  {
+    unrolled_list<int, 16> list;
+    list.reserve(100);
+    assert(list.capacity() == 112);
+    assert(list.node_count() == 1);
+    
+    // already has room
+    list.reserve(50);
+    assert(list.capacity() == 112);
+    
+    for (int i = 0; i < 10; ++i) {
+      list.emplace_back(i);
+    }
+    
+    std::vector<int> src(90);
+    std::iota(src.begin(), src.end(), 10);
+    list.append_range(src);
+    
+    assert(list.size() == 100);
+    assert(list.node_count() == 7);
+    assert(list.capacity() == 112);
+    for (int i = 0; i < 100; ++i) {
+      assert(list[i] == i);
+    }
+    
+    // the spare nodes that are left get used before allocating
+    list.append_range(src);
+    assert(list.size() == 190);
+    assert(list.capacity() == 192);
+  }
+  
+  // it should refill its own nodes on assign
+  {
+    typedef unrolled_list<int, 8, minmax_policy> list_type;
+    
+    list_type list;
+    for (int i = 0; i < 64; ++i) {
+      list.emplace_back(i);
+    }
+    assert(list.node_count() == 8);
+    auto const capacity = list.capacity();
+    
+    list.assign({5, 4, 3, 2, 1, 0, -1, -2, -3, -4});
+    assert(list.size() == 10);
+    assert(list.node_count() == 2);
+    assert(list.capacity() == capacity);
+    assert(list.front() == 5 && list.back() == -4);
+    
+    auto seg = *list.segments().begin();
+    assert(seg.summary().min == -2 && seg.summary().max == 5);
+    
+    std::vector<int> src(64, 7);
+    list.assign(src.begin(), src.end());
+    assert(list.size() == 64);
+    assert(list.capacity() == capacity);
+    assert(regulus::count(list, 7) == 64);
+  }
+  
+  // it should keep every node's summary up to date
+  {
+    static_assert(std::is_same<
+      unrolled_list<int>::summary_type, regulus::no_summary<int>>::value, "");
+    
+    typedef unrolled_list<int, 8, minmax_policy> list_type;
+    
+    auto check = [](list_type const& list)
+    {
+      for (auto seg : list.segments()) {
+        auto const& summary = seg.summary();
+        if (seg.size() == 0) {
+          assert(summary.empty);
+          continue;
+        }
+        
+        auto const bounds = std::minmax_element(seg.begin(), seg.end());
+        assert(!summary.empty);
+        assert(summary.min == *bounds.first);
+        assert(summary.max == *bounds.second);
+      }
+    };
+    
+    list_type list;
+    std::mt19937 gen{42};
+    for (int i = 0; i < 500; ++i) {
+      auto const pos = gen() % (list.size() + 1);
+      list.insert(list.iterator_at(pos), (int ) (gen() % 1000));
+    }
+    check(list);
+    
+    for (int i = 0; i < 400; ++i) {
+      list.erase(list.iterator_at(gen() % list.size()));
+    }
+    check(list);
+    
+    for (int i = 0; i < 100; ++i) {
+      list.emplace_back(i);
+      list.emplace_front(-i);
+    }
+    check(list);
+    
+    list.clear();
+    check(list);
+  }
+  
+  // it should keep zone maps up to date
+  {
+    typedef unrolled_list<int, 8, zone_policy> list_type;
+    
+    auto check = [](list_type const& list)
+    {
+      for (auto seg : list.segments()) {
+        auto const& summary = seg.summary();
+        assert(summary.count == seg.size());
+        assert(summary.sum == std::accumulate(seg.begin(), seg.end(), 0LL));
+        if (seg.size() > 0) {
+          assert(summary.min == *std::min_element(seg.begin(), seg.end()));
+          assert(summary.max == *std::max_element(seg.begin(), seg.end()));
+        }
+      }
+    };
+    
+    list_type list;
+    std::mt19937 gen{7};
+    for (int i = 0; i < 500; ++i) {
+      auto const pos = gen() % (list.size() + 1);
+      list.insert(list.iterator_at(pos), (int ) (gen() % 1000));
+    }
+    for (int i = 0; i < 200; ++i) {
+      list.erase(list.iterator_at(gen() % list.size()));
+    }
+    check(list);
+    
+    list.erase_if([](int const x) { return x % 3 == 0; });
+    check(list);
+    
+    list.shrink_to_fit();
+    check(list);
+    
+    for (int i = 0; i < 50; ++i) {
+      list.modify(list.iterator_at(gen() % list.size()), [](int& x)
+      {
+        x += 5000;
+      });
+    }
+    check(list);
+    
+    regulus::for_each(list, [](int& x)
+    {
+      x -= 100;
+    });
+    check(list);
+    
+    regulus::parallel_transform_inplace(list, [](int x)
+    {
+      return x * 2;
+    });
+    check(list);
+  }
+  
+  // it should give the same answers with and without zone maps
+  {
+    typedef unrolled_list<int, 8, zone_policy> list_type;
+    
+    list_type list;
+    std::mt19937 gen{11};
+    for (int i = 0; i < 2000; ++i) {
+      list.emplace_back(i + (int ) (gen() % 50));
+    }
+    
+    for (int i = 0; i < 100; ++i) {
+      auto const lo = (int ) (gen() % 2100);
+      auto const hi = lo + (int ) (gen() % 300);
+      auto const pred = regulus::between(lo, hi);
+      
+      assert(regulus::zone_count_if(list, pred) == regulus::count_if(list, pred));
+      assert(regulus::zone_find_if(list, pred) == regulus::find_if(list, pred));
+      
+      long long sum = 0;
+      std::vector<int> matches;
+      for (auto const x : list) {
+        if (pred(x)) {
+          sum += x;
+          matches.push_back(x);
+        }
+      }
+      assert(regulus::zone_sum_if(list, pred, 0LL) == sum);
+      
+      std::vector<int> visited;
+      regulus::zone_for_each_if(list, pred, [&visited](int const x)
+      {
+        visited.push_back(x);
+      });
+      assert(visited == matches);
+    }
+    
+    assert(regulus::zone_count_if(list, regulus::at_least(1000)) ==
+      regulus::count_if(list, [](int x) { return x >= 1000; }));
+    assert(regulus::zone_count_if(list, regulus::at_most(1000)) ==
+      regulus::count_if(list, [](int x) { return x <= 1000; }));
+    assert(regulus::zone_find_if(list, regulus::between(-10, -1)) == list.end());
+    assert(regulus::zone_count_if(list_type{}, regulus::at_least(0)) == 0);
+  }
+  
+  // it should only look at the elements of nodes on the range's edges
+  {
+    unrolled_list<int, 8, zone_policy> list;
+    for (int i = 0; i < 10000; ++i) {
+      list.emplace_back(i);
+    }
+    
+    std::size_t calls = 0;
+    counted_range pred{regulus::between(5000, 5100), &calls};
+    assert(regulus::zone_count_if(list, pred) == 101);
+    assert(calls <= 16);
+    
+    calls = 0;
+    assert(*regulus::zone_find_if(list, pred) == 5000);
+    assert(calls == 1);
+  }
+  
+  // it should support segmented algorithms
+  {
+    unrolled_list<int, 16> list;
+    for (int i = 0; i < 100; ++i) {
+      list.emplace_back(i);
+    }
+    
+    regulus::for_each(list, [](int& x)
+    {
+      x *= 2;
+    });
+    
+    assert(regulus::accumulate(list, 0) == 99 * 100);
+    assert(regulus::accumulate(list, 1LL, [](long long a, int b)
+    {
+      return a + b;
+    }) == 99 * 100 + 1);
+    
+    assert(regulus::count(list, 42) == 1);
+    assert(regulus::count(list, 43) == 0);
+    assert(regulus::count_if(list, [](int x) { return x % 4 == 0; }) == 50);
+    
+    auto it = regulus::find(list, 84);
+    assert(it != list.end());
+    assert(*it == 84);
+    assert(list.index_of(it) == 42);
+    assert(regulus::find(list, 85) == list.end());
+    
+    // a hit on the last element of a segment should still give
+    // a proper iterator
+    it = regulus::find_if(list, [](int x) { return x == 30; });
+    assert(*it == 30);
+    ++it;
+    assert(*it == 32);
+    
+    std::vector<int> out(list.size());
+    regulus::transform(list, out.begin(), [](int x)
+    {
+      return x / 2;
+    });
+    for (int i = 0; i < 100; ++i) {
+      assert(out[i] == i);
+    }
+  }
+  
+  // it should run the simd kernels segment by segment
+  {
+    unrolled_list<std::int32_t, 64> ints;
+    unrolled_list<float, 64> floats;
+    unrolled_list<std::uint64_t, 64> longs;
+    
+    std::mt19937 gen{5};
+    for (int i = 0; i < 1000; ++i) {
+      auto const val = gen() % 500;
+      ints.insert(ints.iterator_at(gen() % (ints.size() + 1)), (std::int32_t ) val);
+      floats.emplace_back((float ) val);
+      longs.emplace_back(val << 40);
+    }
+    
+    for (std::int32_t needle = 0; needle < 600; needle += 7) {
+      assert(
+        regulus::simd::find(ints, needle) ==
+        std::find(ints.begin(), ints.end(), needle));
+      assert(
+        regulus::simd::count(ints, needle) ==
+        (std::size_t ) std::count(ints.begin(), ints.end(), needle));
+      assert(
+        regulus::simd::contains(floats, (float ) needle) ==
+        (std::find(floats.begin(), floats.end(), (float ) needle) != floats.end()));
+      assert(
+        regulus::simd::count(longs, (std::uint64_t ) needle << 40) ==
+        regulus::count(longs, (std::uint64_t ) needle << 40));
+    }
+    
+    assert(regulus::simd::min_element(ints) == std::min_element(ints.begin(), ints.end()));
+    assert(regulus::simd::max_element(ints) == std::max_element(ints.begin(), ints.end()));
+    assert(regulus::simd::min_element(longs) == std::min_element(longs.begin(), longs.end()));
+    assert(regulus::simd::max_element(floats) == std::max_element(floats.begin(), floats.end()));
+    assert(regulus::simd::accumulate(ints, 3) == regulus::accumulate(ints, 3));
+    assert(
+      regulus::simd::accumulate(longs, std::uint64_t{0}) ==
+      regulus::accumulate(longs, std::uint64_t{0}));
+    
+    // every element is a whole number so the order they're added in
+    // doesn't change the result
+    assert(regulus::simd::accumulate(floats, 0.0f) == regulus::accumulate(floats, 0.0f));
+    
+    unrolled_list<std::int32_t> empty;
+    assert(regulus::simd::min_element(empty) == empty.end());
+    assert(regulus::simd::find(empty, 1) == empty.end());
+    assert(regulus::simd::accumulate(empty, 4) == 4);
+    
+    // summing in long long goes past what the elements could hold
+    unrolled_list<std::int32_t> bigs;
+    for (int i = 0; i < 1000; ++i) {
+      bigs.emplace_back(INT32_MAX);
+    }
+    assert(regulus::simd::accumulate(bigs, 0LL) == 1000LL * INT32_MAX);
+    assert(regulus::simd::accumulate(bigs, 0LL) == regulus::accumulate(bigs, 0LL));
+  }
+  
+  // it should support parallel traversal
+  {
+    regulus::thread_pool pool{4};
+    assert(pool.size() == 4);
+    
+    unrolled_list<int, 64> list;
+    int const size = 1024 * 256;
+    for (int i = 0; i < size; ++i) {
+      list.emplace_back(i);
+    }
+    
+    std::atomic<long long> visited{0};
+    regulus::parallel_for_each(list, [&](int x)
+    {
+      visited += x;
+    }, pool);
+    
+    long long const expected = (long long ) (size - 1) * size / 2;
+    assert(visited == expected);
+    
+    assert(regulus::parallel_reduce(list, 0LL, [](long long a, long long b)
+    {
+      return a + b;
+    }, pool) == expected);
+    
+    regulus::parallel_transform_inplace(list, [](int x)
+    {
+      return x * 2;
+    }, pool);
+    
+    int i = 0;
+    for (auto l : list) {
+      assert(l == i * 2);
+      ++i;
+    }
+    
+    // small lists and the default pool should work just the same
+    unrolled_list<int> small;
+    for (int i = 0; i < 100; ++i) {
+      small.emplace_back(i);
+    }
+    assert(regulus::parallel_reduce(small) == 4950);
+    
+    // exceptions should make it back to the caller
+    try {
+      regulus::parallel_for_each(list, [](int x)
+      {
+        if (x == 1000) {
+          throw std::runtime_error{"oops"};
+        }
+      }, pool);
+      assert(false);
+    } catch (std::runtime_error& e) {
+    }
+  }
+  
+  // it should reduce into a different type than the elements
+  {
+    regulus::thread_pool pool{4};
+    
+    unrolled_list<std::string, 16> strings;
+    std::size_t expected = 0;
+    for (int i = 0; i < 40000; ++i) {
+      strings.emplace_back(std::to_string(i));
+      expected += strings.back().size();
+    }
+    assert(strings.size() >= regulus::detail::parallel_cutoff);
+    
+    unrolled_list<std::string, 16> few;
+    few.emplace_back("a");
+    few.emplace_back("bc");
+    few.emplace_back("def");
+    assert(few.size() < regulus::detail::parallel_cutoff);
+    
+    assert(regulus::parallel_reduce(
+      strings, std::size_t{0}, string_length_sum{}, pool) == expected);
+    assert(regulus::parallel_reduce(
+      few, std::size_t{0}, string_length_sum{}, pool) == 6);
+  }
+  
+  // it should take appends from several threads at once
+  {
+    regulus::concurrent_unrolled_list<int, 16> list;
+    int const producers = 4;
+    int const per_producer = 20000;
+    int const total = producers * per_producer;
+    
+    // a reader running alongside should only ever see a growing
+    // prefix of valid elements
+    std::atomic<bool> done{false};
+    std::thread reader([&]
+    {
+      std::size_t last_seen = 0;
+      while (!done.load()) {
+        std::size_t seen = 0;
+        for (auto const l : list) {
+          assert(l >= 0 && l < total);
+          ++seen;
+        }
+        assert(seen >= last_seen);
+        last_seen = seen;
+      }
+    });
+    
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+      threads.emplace_back([&list, p, per_producer]
+      {
+        for (int i = 0; i < per_producer; ++i) {
+          list.emplace_back(p * per_producer + i);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    done = true;
+    reader.join();
+    
+    assert(list.size() == (std::size_t ) total);
+    assert(std::distance(list.begin(), list.end()) == total);
+    
+    // every value shows up once and each producer's values in order
+    std::vector<bool> found(total, false);
+    std::vector<int> last(producers, -1);
+    for (auto const l : list) {
+      assert(!found[l]);
+      found[l] = true;
+      
+      auto const p = l / per_producer;
+      assert(l > last[p]);
+      last[p] = l;
+    }
+    
+    std::size_t in_segments = 0;
+    list.for_each_segment([&](int const* first, int const* last)
+    {
+      in_segments += last - first;
+    });
+    assert(in_segments == (std::size_t ) total);
+  }
+  
+  // it should work as a FIFO queue
+  {
+    regulus::segmented_queue<int, 4> queue;
+    assert(queue.empty());
+    
+    for (int i = 0; i < 10; ++i) {
+      queue.push(i);
+      assert(queue.back() == i);
+    }
+    assert(queue.size() == 10);
+    assert(queue.node_count() == 3);
+    
+    for (int i = 0; i < 10; ++i) {
+      assert(queue.front() == i);
+      queue.pop();
+    }
+    assert(queue.empty());
+    
+    // the drained nodes stick around for reuse
+    assert(queue.node_count() == 3);
+    queue.shrink_to_fit();
+    assert(queue.node_count() == 1);
+  }
+  
+  // it shouldn't allocate once the queue stops growing
+  {
+    typedef counting_allocator<int> alloc_type;
+    regulus::segmented_queue<int, 8, alloc_type> queue;
+    
+    for (int i = 0; i < 100; ++i) {
+      queue.push(i);
+    }
+    
+    auto const allocations = alloc_type::allocations;
+    for (int i = 100; i < 10000; ++i) {
+      assert(queue.front() == i - 100);
+      queue.pop();
+      queue.push(i);
+    }
+    assert(alloc_type::allocations == allocations);
+    assert(queue.size() == 100);
+  }
+  
+  // queued elements should be destroyed exactly once
+  {
+    auto const tracker = std::make_shared<int>(0);
+    {
+      regulus::segmented_queue<std::shared_ptr<int>, 4> queue;
+      for (int i = 0; i < 10; ++i) {
+        queue.push(tracker);
+      }
+      for (int i = 0; i < 5; ++i) {
+        queue.pop();
+      }
+      assert(tracker.use_count() == 6);
+    }
+    assert(tracker.use_count() == 1);
+  }
+  
+  // it should keep its elements sorted
+  {
+    typedef regulus::sorted_unrolled_list<int, std::less<int>, 8> list_type;
+    
+    // every node is sorted, in order and has the right keys
+    auto check = [](list_type const& list, std::multiset<int> const& expected)
+    {
+      assert(list.size() == expected.size());
+      assert(std::equal(expected.begin(), expected.end(), list.begin()));
+      assert(std::is_sorted(list.begin(), list.end()));
+      assert(list.node_count() * 8 >= list.size());
+    };
+    
+    list_type list;
+    std::multiset<int> expected;
+    std::mt19937 gen{7};
+    
+    for (int i = 0; i < 2000; ++i) {
+      auto const val = (int ) (gen() % 500);
+      auto it = list.insert(val);
+      assert(*it == val);
+      expected.insert(val);
+    }
+    check(list, expected);
+    
+    for (int key = -1; key <= 501; ++key) {
+      auto const range = list.equal_range(key);
+      assert(std::distance(range.first, range.second) ==
+        (long ) expected.count(key));
+      assert(list.count(key) == expected.count(key));
+      assert(list.contains(key) == (expected.count(key) > 0));
+      
+      auto const lower = list.lower_bound(key);
+      auto const expected_lower = expected.lower_bound(key);
+      assert((lower == list.end()) == (expected_lower == expected.end()));
+      if (lower != list.end()) {
+        assert(*lower == *expected_lower);
+      }
+    }
+    
+    for (int i = 0; i < 1500; ++i) {
+      auto const val = (int ) (gen() % 500);
+      auto it = list.find(val);
+      if (it == list.end()) {
+        assert(expected.count(val) == 0);
+        continue;
+      }
+      
+      auto next = list.erase(it);
+      expected.erase(expected.find(val));
+      if (next != list.end()) {
+        assert(*next >= val);
+      }
+    }
+    check(list, expected);
+    
+    assert(list.erase(42) == expected.erase(42));
+    assert(!list.contains(42));
+    check(list, expected);
+    
+    // backwards too
+    auto it = list.end();
+    auto expected_it = expected.end();
+    while (it != list.begin()) {
+      --it;
+      --expected_it;
+      assert(*it == *expected_it);
+    }
+    
+    list.clear();
+    assert(list.empty() && list.begin() == list.end());
+  }
+  
+  // it should pack sorted inserts and ranges into full nodes
+  {
+    regulus::sorted_unrolled_list<int, std::less<int>, 16> ascending;
+    for (int i = 0; i < 160; ++i) {
+      ascending.insert(i);
+    }
+    assert(ascending.node_count() == 10);
+    
+    std::vector<int> src(160);
+    std::iota(src.begin(), src.end(), 0);
+    std::shuffle(src.begin(), src.end(), std::mt19937{3});
+    
+    regulus::sorted_unrolled_list<int, std::greater<int>, 16> descending(
+      src.begin(), src.end(), std::greater<int>{});
+    assert(descending.node_count() == 10);
+    assert(*descending.begin() == 159);
+    assert(*descending.lower_bound(100) == 100);
+    assert(*descending.upper_bound(100) == 99);
+  }
+  
+  // inserting one of its own elements into a full node should copy it first
+  {
+    regulus::sorted_unrolled_list<tracked_key, std::less<tracked_key>, 8> list;
+    for (int i = 0; i < 8; ++i) {
+      list.insert(tracked_key{i});
+    }
+    assert(list.node_count() == 1);
+    
+    list.insert(*std::next(list.begin(), 6));
+    assert(list.node_count() == 2 && list.count(tracked_key{6}) == 2);
+    
+    list.insert(*std::prev(list.end()));
+    list.insert(*list.begin());
+    
+    int const expected[] = {0, 0, 1, 2, 3, 4, 5, 6, 6, 7, 7};
+    assert(std::equal(
+      list.begin(), list.end(), std::begin(expected), std::end(expected),
+      [](tracked_key const& key, int const val) { return key.val == val; }));
+  }
+  
+  // a failed append shouldn't hold up the ones after it
+  {
+    struct picky
+    {
+      int val;
+      
+      picky(int v)
+        : val{v}
+      {
+        if (v == 3) {
+          throw std::runtime_error{"no threes"};
+        }
+      }
+    };
+    
+    regulus::concurrent_unrolled_list<picky, 4> list;
+    for (int i = 0; i < 10; ++i) {
+      try {
+        list.emplace_back(i);
+      } catch (std::runtime_error& e) {
+      }
+    }
+    
+    assert(list.size() == 9);
+    int expected = 0;
+    for (auto const& l : list) {
+      if (expected == 3) {
+        ++expected;
+      }
+      assert(l.val == expected);
+      ++expected;
+    }
+    assert(expected == 10);
+    
+    std::size_t segments = 0;
+    list.for_each_segment([&](picky const*, picky const*)
+    {
+      ++segments;
+    });
+    assert(segments == 3);
+  }
+  
+  int num_elements = 1024 * 1024 * 2;
+  
+  double my_time = 0;
+  double stl_time = 0;
+  
+  {
+    auto begin = std::clock();
+    regulus::unrolled_list<int> list;
+    for (int i = 0; i < num_elements; ++i) {
+      list.emplace_back(i);
+    }
+    
+    auto it = list.begin();
+    do {
+      ++it;
+    } while (it != list.end());
+    
+    auto end = std::clock();
+    my_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+  }
+  
+  {
+    auto begin = std::clock();
+    
+    std::list<int> list_;
+    for (int i = 0; i < num_elements; ++i) {
+      list_.emplace_back(i);
+    }
+    
+    auto it = list_.begin();
+    do {
+      ++it;
+    } while (it != list_.end());
+    
+    auto end = std::clock();
+    stl_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+  }
+  
+  double half_time = 0;
+  std::size_t my_nodes = 0;
+  std::size_t half_nodes = 0;
+  
+  {
+    regulus::unrolled_list<int> list;
+    for (int i = 0; i < num_elements; ++i) {
+      list.emplace_back(i);
+    }
+    my_nodes = list.node_count();
+  }
+  
+  {
+    auto begin = std::clock();
+    regulus::unrolled_list<
+      int,
+      regulus::unrolled_list<int>::node_size,
+      regulus::half_split_policy> list;
+    
+    for (int i = 0; i < num_elements; ++i) {
+      list.emplace_back(i);
+    }
+    
+    auto it = list.begin();
+    do {
+      ++it;
+    } while (it != list.end());
+    
+    auto end = std::clock();
+    half_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    half_nodes = list.node_count();
+  }
+  
+  double pool_time = 0;
+  
+  {
+    auto begin = std::clock();
+    regulus::unrolled_list<
+      int,
+      regulus::unrolled_list<int>::node_size,
+      regulus::fill_split_policy,
+      regulus::pool_allocator<int>> list;
+    
+    for (int i = 0; i < num_elements; ++i) {
+      list.emplace_back(i);
+    }
+    
+    auto it = list.begin();
+    do {
+      ++it;
+    } while (it != list.end());
+    
+    auto end = std::clock();
+    pool_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+  }
+  
+  double seek_time = 0;
+  
+  {
+    regulus::unrolled_list<int> list;
+    for (int i = 0; i < num_elements; ++i) {
+      list.emplace_back(i);
+    }
+    
+    std::mt19937 gen{1337};
+    long long sum = 0;
+    
+    auto begin = std::clock();
+    for (int i = 0; i < 1024 * 1024; ++i) {
+      sum += list[gen() % num_elements];
+    }
+    auto end = std::clock();
+    
+    assert(sum > 0);
+    seek_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+  }
+  
+  double iter_scan_time = 0;
+  double segment_scan_time = 0;
+  
+  {
+    regulus::unrolled_list<int> list;
+    for (int i = 0; i < num_elements; ++i) {
+      list.emplace_back(i);
+    }
+    
+    int const passes = 16;
+    long long iter_sum = 0;
+    long long segment_sum = 0;
+    
+    auto begin = std::clock();
+    for (int i = 0; i < passes; ++i) {
+      for (auto l : list) {
+        iter_sum += l;
+      }
+    }
+    auto end = std::clock();
+    iter_scan_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    
+    begin = std::clock();
+    for (int i = 0; i < passes; ++i) {
+      segment_sum = regulus::accumulate(list, segment_sum);
+    }
+    end = std::clock();
+    segment_scan_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    
+    assert(iter_sum == segment_sum);
+  }
+  
+  double parallel_scan_time = 0;
+  
+  {
+    regulus::unrolled_list<int> list;
+    for (int i = 0; i < num_elements; ++i) {
+      list.emplace_back(i);
+    }
+    
+    int const passes = 16;
+    long long sum = 0;
+    
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < passes; ++i) {
+      sum += regulus::parallel_reduce(list, 0LL, [](long long a, long long b)
+      {
+        return a + b;
+      });
+    }
+    auto end = std::chrono::steady_clock::now();
+    parallel_scan_time = std::chrono::duration<double>(end - begin).count();
+    
+    assert(sum == regulus::accumulate(list, 0LL) * passes);
+  }
+  
+  // scattered nodes make every hop a cache miss unless it's been
+  // prefetched, so this is where the prefetch distance shows
+  int const scattered_elements = num_elements * 4;
+  int const scattered_passes = 4;
+  
+  double scattered_no_time = scattered_scan<no_prefetch_policy>(
+    scattered_elements, scattered_passes);
+  double scattered_time = scattered_scan<regulus::fill_split_policy>(
+    scattered_elements, scattered_passes);
+  double scattered_far_time = scattered_scan<far_prefetch_policy>(
+    scattered_elements, scattered_passes);
+  double reindex_time = scattered_reindex(scattered_elements, 64);
+  double front_insert_time = indexed_inserts(num_elements, 100000, true);
+  double back_insert_time = indexed_inserts(num_elements, 100000, false);
+  
+  double emplace_load_time = 0;
+  double bulk_load_time = 0;
+  
+  {
+    std::vector<int> src(num_elements * 4);
+    std::iota(src.begin(), src.end(), 0);
+    
+    auto begin = std::clock();
+    {
+      regulus::unrolled_list<int> list;
+      for (auto const val : src) {
+        list.emplace_back(val);
+      }
+      assert(list.size() == src.size());
+    }
+    auto end = std::clock();
+    emplace_load_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    
+    begin = std::clock();
+    {
+      regulus::unrolled_list<int> list(src.begin(), src.end());
+      assert(list.size() == src.size());
+    }
+    end = std::clock();
+    bulk_load_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+  }
+  
+  double locked_append_time = 0;
+  double concurrent_append_time = 0;
+  
+  {
+    int const producers = 4;
+    int const per_producer = num_elements / producers;
+    
+    auto run = [&](auto append)
+    {
+      auto begin = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&append, per_producer]
+        {
+          for (int i = 0; i < per_producer; ++i) {
+            append(i);
+          }
+        });
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      auto end = std::chrono::steady_clock::now();
+      return std::chrono::duration<double>(end - begin).count();
+    };
+    
+    regulus::unrolled_list<int> locked;
+    std::mutex mutex;
+    locked_append_time = run([&](int const val)
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      locked.emplace_back(val);
+    });
+    
+    regulus::concurrent_unrolled_list<int> concurrent;
+    concurrent_append_time = run([&](int const val)
+    {
+      concurrent.emplace_back(val);
+    });
+    
+    assert(locked.size() == concurrent.size());
+  }
+  
+  int const queue_depth = 1000;
+  int const queue_rounds = num_elements * 4;
+  long long queue_sum = 0;
+  long long deque_sum = 0;
+  long long list_queue_sum = 0;
+  
+  double queue_time = run_queue<regulus::segmented_queue<int>>(
+    queue_depth, queue_rounds, queue_sum);
+  double deque_time = run_queue<std::queue<int, std::deque<int>>>(
+    queue_depth, queue_rounds, deque_sum);
+  double list_queue_time = run_queue<std::queue<int, std::list<int>>>(
+    queue_depth, queue_rounds, list_queue_sum);
+  
+  assert(queue_sum == deque_sum && queue_sum == list_queue_sum);
+  
+  double sorted_insert_time = 0;
+  double sorted_lookup_time = 0;
+  double set_insert_time = 0;
+  double set_lookup_time = 0;
+  
+  {
+    int const num_keys = 1024 * 1024;
+    std::vector<int> keys(num_keys);
+    std::mt19937 gen{1337};
+    for (auto& key : keys) {
+      key = (int ) gen();
+    }
+    
+    regulus::sorted_unrolled_list<int> sorted;
+    std::set<int> set;
+    long long sorted_hits = 0;
+    long long set_hits = 0;
+    
+    auto begin = std::clock();
+    for (auto const key : keys) {
+      sorted.insert(key);
+    }
+    auto end = std::clock();
+    sorted_insert_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    
+    begin = std::clock();
+    for (auto const key : keys) {
+      set.insert(key);
+    }
+    end = std::clock();
+    set_insert_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    
+    std::shuffle(keys.begin(), keys.end(), gen);
+    
+    begin = std::clock();
+    for (auto const key : keys) {
+      sorted_hits += *sorted.lower_bound(key) == key;
+    }
+    end = std::clock();
+    sorted_lookup_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    
+    begin = std::clock();
+    for (auto const key : keys) {
+      set_hits += *set.lower_bound(key) == key;
+    }
+    end = std::clock();
+    set_lookup_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    
+    assert(sorted_hits == set_hits);
+  }
+  
+  double std_reduce_time = 0;
+  double simd_reduce_time = 0;
+  double std_node_time = 0;
+  double simd_node_time = 0;
+  
+  {
+    unrolled_list<std::int32_t> values;
+    std::mt19937 gen{123};
+    for (int i = 0; i < 8 * 1024 * 1024; ++i) {
+      values.emplace_back((std::int32_t ) (gen() % 200));
+    }
+    
+    int const passes = 10;
+    long long std_result = 0;
+    long long simd_result = 0;
+    
+    // count, find (a miss), min, max and sum over the whole list
+    auto begin = std::clock();
+    for (int i = 0; i < passes; ++i) {
+      std_result += regulus::count(values, i);
+      std_result += regulus::find(values, -1) == values.end();
+      std_result += *std::min_element(values.begin(), values.end());
+      std_result += *std::max_element(values.begin(), values.end());
+      std_result += regulus::accumulate(values, 0);
+    }
+    auto end = std::clock();
+    std_reduce_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    
+    begin = std::clock();
+    for (int i = 0; i < passes; ++i) {
+      simd_result += regulus::simd::count(values, i);
+      simd_result += regulus::simd::find(values, -1) == values.end();
+      simd_result += *regulus::simd::min_element(values);
+      simd_result += *regulus::simd::max_element(values);
+      simd_result += regulus::simd::accumulate(values, 0);
+    }
+    end = std::clock();
+    simd_reduce_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    
+    assert(std_result == simd_result);
+    
+    // a single cache resident node's worth of floats
+    regulus::static_vector<float, 256> node;
+    for (int i = 0; i < 256; ++i) {
+      node.emplace_back((float ) (gen() % 1000));
+    }
+    
+    int const rounds = 1000000;
+    float std_sum = 0;
+    float simd_sum = 0;
+    
+    begin = std::clock();
+    for (int i = 0; i < rounds; ++i) {
+      std_sum += *std::min_element(node.begin(), node.end());
+      std_sum += std::count(node.begin(), node.end(), (float ) (i % 1000));
+    }
+    end = std::clock();
+    std_node_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    
+    begin = std::clock();
+    for (int i = 0; i < rounds; ++i) {
+      simd_sum += *regulus::simd::min_element(node);
+      simd_sum += regulus::simd::count(node, (float ) (i % 1000));
+    }
+    end = std::clock();
+    simd_node_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    
+    assert(std_sum == simd_sum);
+  }
+  
+  double plain_filter_time = 0;
+  double zone_filter_time = 0;
+  
+  {
+    // timestamps that arrive slightly out of order
+    unrolled_list<int, regulus::default_node_size<int>::value, zone_policy> events;
+    std::mt19937 gen{99};
+    int const num_events = 8 * 1024 * 1024;
+    for (int i = 0; i < num_events; ++i) {
+      events.emplace_back(i * 4 + (int ) (gen() % 16));
+    }
+    
+    int const num_queries = 100;
+    int const width = num_events * 4 / 100;
+    std::vector<int> starts(num_queries);
+    for (auto& start : starts) {
+      start = (int ) (gen() % (num_events * 4 - width));
+    }
+    
+    std::size_t plain_hits = 0;
+    std::size_t zone_hits = 0;
+    
+    auto begin = std::clock();
+    for (auto const start : starts) {
+      plain_hits += regulus::count_if(events, regulus::between(start, start + width));
+    }
+    auto end = std::clock();
+    plain_filter_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    
+    begin = std::clock();
+    for (auto const start : starts) {
+      zone_hits += regulus::zone_count_if(events, regulus::between(start, start + width));
+    }
+    end = std::clock();
+    zone_filter_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    
+    assert(plain_hits == zone_hits);
+  }
+  
+  double erase_loop_time = 0;
+  double erase_if_time = 0;
+  
+  {
+    // a retention sweep that drops about 20% of the entries
+    int const num_entries = 4 * 1024 * 1024;
+    auto const expired = [](int const x) { return x % 5 == 0; };
+    
+    unrolled_list<int> looped;
+    unrolled_list<int> swept;
+    std::mt19937 gen{5};
+    for (int i = 0; i < num_entries; ++i) {
+      auto const val = (int ) (gen() % 1000);
+      looped.emplace_back(val);
+      swept.emplace_back(val);
+    }
+    
+    auto begin = std::clock();
+    for (auto it = looped.begin(); it != looped.end(); ) {
+      if (expired(*it)) {
+        it = looped.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    auto end = std::clock();
+    erase_loop_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    
+    begin = std::clock();
+    swept.erase_if(expired);
+    end = std::clock();
+    erase_if_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    
+    assert(looped.size() == swept.size());
+    assert(std::equal(looped.begin(), looped.end(), swept.begin()));
+  }
+  
+  double half_full_scan_time = 0;
+  double shrink_time = 0;
+  double packed_scan_time = 0;
+  std::size_t half_full_nodes = 0;
+  std::size_t packed_nodes = 0;
+  
+  {
+    // half split appends leave every node but the tail half empty and
+    // the nodes are scattered over the heap like in a long lived list
+    typedef unrolled_list<
+      int, unrolled_list<int>::node_size,
+      regulus::half_split_policy, scattered_allocator<int>> list_type;
+    
+    int const num_elements = 8 * 1024 * 1024;
+    auto const slots = num_elements / (list_type::node_size / 2) + 2;
+    list_type half{scattered_allocator<int>{std::make_shared<scatter_arena>(slots)}};
+    list_type packed{scattered_allocator<int>{std::make_shared<scatter_arena>(slots)}};
+    for (int i = 0; i < num_elements; ++i) {
+      half.emplace_back(i);
+      packed.emplace_back(i);
+    }
+    
+    auto begin = std::clock();
+    packed.shrink_to_fit();
+    auto end = std::clock();
+    shrink_time = double{(double ) end - begin} / CLOCKS_PER_SEC;
+    half_full_nodes = half.node_count();
+    packed_nodes = packed.node_count();
+    
+    auto const scan = [](list_type const& list, long long& sum)
+    {
+      auto const begin = std::clock();
+      list.for_each_segment([&sum](int const* first, int const* last)
+      {
+        for (; first != last; ++first) {
+          sum += *first;
+        }
+      });
+      return double{(double ) std::clock() - begin} / CLOCKS_PER_SEC;
+    };
+    
+    // one untimed pass over each to warm up, then alternate between them
+    long long half_sum = 0;
+    long long packed_sum = 0;
+    scan(half, half_sum);
+    scan(packed, packed_sum);
+    
+    int const passes = 10;
+    for (int i = 0; i < passes; ++i) {
+      half_full_scan_time += scan(half, half_sum);
+      packed_scan_time += scan(packed, packed_sum);
+    }
+    
+    assert(half_sum == packed_sum);
   }
   
-  std::cout << "My time : " << my_time << std::endl;
+  std::cout << "My time : " << my_time << " (" << my_nodes << " nodes)" << std::endl;
+  std::cout << "Half split time : " << half_time << " (" << half_nodes << " nodes)" << std::endl;
+  std::cout << "Pool time : " << pool_time << std::endl;
   std::cout << "STL time : " << stl_time << std::endl;
+  std::cout << "1M random seeks : " << seek_time << std::endl;
+  std::cout << "Iterator scan : " << iter_scan_time << std::endl;
+  std::cout << "Segmented scan : " << segment_scan_time << std::endl;
+  std::cout << "Parallel scan (" << regulus::thread_pool::default_pool().size()
+            << " threads) : " << parallel_scan_time << std::endl;
+  std::cout << "Scattered scan (no prefetch) : " << scattered_no_time << std::endl;
+  std::cout << "Scattered scan (prefetch " << REGULUS_PREFETCH_DISTANCE
+            << ") : " << scattered_time << std::endl;
+  std::cout << "Scattered scan (prefetch 4) : " << scattered_far_time << std::endl;
+  std::cout << "Scattered index rebuilds : " << reindex_time << std::endl;
+  std::cout << "100K indexed inserts (front) : " << front_insert_time << std::endl;
+  std::cout << "100K indexed inserts (back) : " << back_insert_time << std::endl;
+  std::cout << "8M emplace_back load : " << emplace_load_time << std::endl;
+  std::cout << "8M range load : " << bulk_load_time << std::endl;
+  std::cout << "4 producers (mutex) : " << locked_append_time << std::endl;
+  std::cout << "4 producers (lock-free) : " << concurrent_append_time << std::endl;
+  std::cout << "Queue churn (segmented_queue) : " << queue_time << std::endl;
+  std::cout << "Queue churn (std::deque) : " << deque_time << std::endl;
+  std::cout << "Queue churn (std::list) : " << list_queue_time << std::endl;
+  std::cout << "1M sorted inserts (sorted_unrolled_list) : " << sorted_insert_time << std::endl;
+  std::cout << "1M sorted inserts (std::set) : " << set_insert_time << std::endl;
+  std::cout << "1M lookups (sorted_unrolled_list) : " << sorted_lookup_time << std::endl;
+  std::cout << "1M lookups (std::set) : " << set_lookup_time << std::endl;
+  std::cout << "100 1% range counts (count_if) : " << plain_filter_time << std::endl;
+  std::cout << "100 1% range counts (zone_count_if) : " << zone_filter_time << std::endl;
+  std::cout << "8M int reductions (std) : " << std_reduce_time << std::endl;
+  std::cout << "8M int reductions (simd) : " << simd_reduce_time << std::endl;
+  std::cout << "1M float node min/count (std) : " << std_node_time << std::endl;
+  std::cout << "1M float node min/count (simd) : " << simd_node_time << std::endl;
+  std::cout << "4M retention sweep (erase loop) : " << erase_loop_time << std::endl;
+  std::cout << "4M retention sweep (erase_if) : " << erase_if_time << std::endl;
+  std::cout << "10 scattered half full segmented scans : " << half_full_scan_time << " (" << half_full_nodes << " nodes)" << std::endl;
+  std::cout << "8M shrink_to_fit : " << shrink_time << std::endl;
+  std::cout << "10 scattered packed segmented scans : " << packed_scan_time << " (" << packed_nodes << " nodes)" << std::endl;
 }